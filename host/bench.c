@@ -0,0 +1,334 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ui.h"
+
+/* replays reader work over a real lexis.dat and font set and reports
+ * ns/op.  the app is linked in whole, with its main renamed, so every
+ * number goes through the same code as the rom.
+ *
+ *   make host-bench && build/host/lexis-bench romfs */
+
+enum {
+  BENCH_MAX_WORDS = 512,
+  BENCH_HIT_STEP = 8, /* touch grid spacing in pixels */
+  BENCH_SCROLL_LINES = 120, /* lines stepped through per book */
+  BENCH_TURNS = 20,         /* R presses per book */
+};
+
+static tap_word s_taps[BENCH_MAX_WORDS];
+static int s_tap_count;
+
+static uint64_t now_ns(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+static void report(const char *what, long ops, uint64_t ns) {
+  printf("%-24s %8ld ops %10.0f ns/op\n", what, ops,
+         ops ? (double)ns / (double)ops : 0.0);
+}
+
+static void set_zoom(int z) {
+  g_zoom_level = z;
+  g_font = font_get(g_font_family, z);
+  recompute_page_lines();
+}
+
+/* show_text plus the vblank that hands the frame to the screens */
+static void turn_to(int book, int line) {
+  g_book = book;
+  g_line_num = line;
+  g_row_offset = 0;
+  show_text();
+  tr_present();
+  swiWaitForVBlank();
+}
+
+static void bench_page_turns(void) {
+  for (int fs = 1; fs >= 0; fs--) {
+    g_fullscreen = fs;
+    for (int z = 0; z < NUM_ZOOM_LEVELS; z++) {
+      set_zoom(z);
+      long ops = 0;
+      uint64_t t0 = now_ns();
+      for (int b = 1; b <= g_num_books; b++) {
+        int maxl = reader_max_line(g_ctx, CORPUS_WORK, b);
+        for (int line = 1; line <= maxl; line += g_page_lines) {
+          turn_to(b, line);
+          ops++;
+        }
+      }
+      char what[32];
+      snprintf(what, sizeof(what), "page turn %s %2dpx", fs ? "full" : "split",
+               g_zoom_sizes[z]);
+      report(what, ops, now_ns() - t0);
+    }
+  }
+  g_fullscreen = 1;
+}
+
+/* the page moved down one line at a time, as the d-pad does outside the
+ * glide */
+static void bench_line_scroll(void) {
+  for (int fs = 1; fs >= 0; fs--) {
+    g_fullscreen = fs;
+    for (int z = 0; z < NUM_ZOOM_LEVELS; z++) {
+      set_zoom(z);
+      long ops = 0;
+      uint64_t t0 = now_ns();
+      for (int b = 1; b <= g_num_books; b++) {
+        int maxl = reader_max_line(g_ctx, CORPUS_WORK, b);
+        for (int line = 1; line <= maxl && line <= BENCH_SCROLL_LINES;
+             line++) {
+          turn_to(b, line);
+          ops++;
+        }
+      }
+      char what[32];
+      snprintf(what, sizeof(what), "line scroll %s %2dpx",
+               fs ? "full" : "split", g_zoom_sizes[z]);
+      report(what, ops, now_ns() - t0);
+    }
+  }
+  g_fullscreen = 1;
+}
+
+/* R through the start of each book, with the idle work done or left
+ * undone between presses */
+static void bench_warm_turns(void) {
+  g_fullscreen = 1;
+  for (int z = 0; z < NUM_ZOOM_LEVELS; z++) {
+    set_zoom(z);
+    for (int warm = 0; warm <= 1; warm++) {
+      long ops = 0;
+      uint64_t ns = 0;
+      for (int b = 1; b <= g_num_books; b++) {
+        turn_to(b, 1);
+        while (rows_idle())
+          ;
+        for (int i = 0; i < BENCH_TURNS; i++) {
+          while (warm && idle_work())
+            ;
+          uint64_t t0 = now_ns();
+          turn_page(1);
+          tr_present();
+          swiWaitForVBlank();
+          ns += now_ns() - t0;
+          ops++;
+        }
+      }
+      char what[32];
+      snprintf(what, sizeof(what), "page R %s %2dpx", warm ? "warm" : "cold",
+               g_zoom_sizes[z]);
+      report(what, ops, ns);
+    }
+  }
+}
+
+/* counting every book's row table the way idle frames do; an op is one
+ * idle frame's worth */
+static void bench_rows_index(void) {
+  for (int z = 0; z < NUM_ZOOM_LEVELS; z++) {
+    set_zoom(z);
+    long ops = 0;
+    uint64_t t0 = now_ns();
+    for (int b = 1; b <= g_num_books; b++) {
+      g_book = b;
+      do
+        ops++;
+      while (rows_idle());
+    }
+    char what[32];
+    snprintf(what, sizeof(what), "rows_idle %2dpx", g_zoom_sizes[z]);
+    report(what, ops, now_ns() - t0);
+  }
+}
+
+static void bench_get_lines(void) {
+  reader_line lines[MAX_PAGE_LINES];
+  long ops = 0;
+  uint64_t t0 = now_ns();
+  for (int b = 1; b <= g_num_books; b++) {
+    int maxl = reader_max_line(g_ctx, CORPUS_WORK, b);
+    for (int line = 1; line <= maxl; line += MAX_PAGE_LINES) {
+      reader_frame(g_ctx, READER_FRAME_PAGE);
+      reader_get_lines(g_ctx, CORPUS_WORK, b, line, MAX_PAGE_LINES, lines);
+      ops++;
+    }
+  }
+  report("reader_get_lines", ops, now_ns() - t0);
+}
+
+/* touches a grid over the bottom screen of a few pages per book; the
+ * words it finds feed the lookup bench */
+static void bench_hit_tests(void) {
+  set_zoom(1);
+  long ops = 0;
+  uint64_t ns = 0;
+  for (int b = 1; b <= g_num_books; b++) {
+    int maxl = reader_max_line(g_ctx, CORPUS_WORK, b);
+    for (int line = 1; line <= maxl; line += maxl / 4 + 1) {
+      turn_to(b, line);
+      uint64_t t0 = now_ns();
+      for (int y = 0; y < TR_SCREEN_H; y += BENCH_HIT_STEP)
+        for (int x = 0; x < TR_SCREEN_W; x += BENCH_HIT_STEP) {
+          tap_word tap;
+          ops++;
+          if (!touch_to_word(x, y, &tap))
+            continue;
+          if (s_tap_count < BENCH_MAX_WORDS &&
+              (!s_tap_count ||
+               strcmp(s_taps[s_tap_count - 1].word, tap.word) != 0))
+            s_taps[s_tap_count++] = tap;
+        }
+      ns += now_ns() - t0;
+    }
+  }
+  report("touch_to_word", ops, ns);
+}
+
+static void bench_lookups(void) {
+  if (!s_tap_count)
+    return;
+  long ops = 0;
+  uint64_t t0 = now_ns();
+  for (int i = 0; i < s_tap_count; i++) {
+    build_lookup_result(s_taps[i].word, 0);
+    ops++;
+  }
+  report("build_lookup_result", ops, now_ns() - t0);
+
+  /* taps come with their punctuation attached; the tiers find them */
+  int found = 0;
+  for (int i = 0; i < s_tap_count; i++) {
+    reader_morph m;
+    reader_frame(g_ctx, READER_FRAME_LOOKUP);
+    found += reader_morph_lookup(g_ctx, s_taps[i].word, &m, 1) > 0;
+  }
+  printf("%-24s %8d of %d taps\n", "form lookup hits", found, s_tap_count);
+
+  ops = 0;
+  t0 = now_ns();
+  for (int i = 0; i < s_tap_count; i++) {
+    build_tap_result(&s_taps[i]);
+    ops++;
+  }
+  report("build_tap_result", ops, now_ns() - t0);
+}
+
+/* the lines each tapped form occurs in, then the search screen opened
+ * from its lookup; the largest list is what a common word costs */
+static void bench_search(void) {
+  static reader_pos hits[MAX_SEARCH_HITS];
+  if (!s_tap_count)
+    return;
+  long ops = 0;
+  int most = 0;
+  uint64_t t0 = now_ns();
+  for (int i = 0; i < s_tap_count; i++) {
+    int n = reader_search(g_ctx, READER_SEARCH_FORM, s_taps[i].word, hits,
+                          MAX_SEARCH_HITS);
+    if (n > most)
+      most = n;
+    ops++;
+  }
+  report("reader_search", ops, now_ns() - t0);
+  printf("%-24s %8d lines\n", "largest form list", most);
+
+  ops = 0;
+  t0 = now_ns();
+  for (int i = 0; i < s_tap_count; i++) {
+    build_tap_result(&s_taps[i]);
+    on_lookup_X(ST_LOOKUP);
+    ops++;
+  }
+  report("search screen", ops, now_ns() - t0);
+}
+
+/* a keystroke of the dictionary browse: every one- and two-letter prefix,
+ * the ones that match the most lemmas */
+static void bench_browse(void) {
+  static const char letters[] = "αβγδεζηθικλμνξοπρστυφχψω";
+  enum { GREEK_BYTES = 2 };
+  long ops = 0;
+  int most = 0;
+  uint64_t ns = 0, worst = 0;
+  kb_open(KB_MODE_DICT);
+  for (int a = 0; letters[a]; a += GREEK_BYTES)
+    for (int b = -GREEK_BYTES; b < 0 || letters[b]; b += GREEK_BYTES) {
+      memcpy(g_kb.buf, letters + a, GREEK_BYTES);
+      g_kb.len = GREEK_BYTES;
+      if (b >= 0) {
+        memcpy(g_kb.buf + g_kb.len, letters + b, GREEK_BYTES);
+        g_kb.len += GREEK_BYTES;
+      }
+      g_kb.buf[g_kb.len] = '\0';
+      uint64_t t0 = now_ns();
+      browse_run();
+      uint64_t t = now_ns() - t0;
+      ns += t;
+      if (t > worst)
+        worst = t;
+      int total;
+      reader_lex_entry e;
+      reader_lex_prefix(g_ctx, g_kb.buf, 0, &e, 1, &total);
+      if (total > most)
+        most = total;
+      ops++;
+    }
+  report("browse keystroke", ops, ns);
+  printf("%-24s %8.0f ns, %d lemmas at most\n", "browse worst", (double)worst,
+         most);
+}
+
+int main(int argc, char **argv) {
+  const char *dir = argc > 1 ? argv[1] : "romfs";
+  char path[256];
+
+  snprintf(path, sizeof(path), "%s/lexis.dat", dir);
+  g_ctx = reader_open(path);
+  if (!g_ctx) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 1;
+  }
+  g_num_books = reader_book_count(g_ctx, CORPUS_WORK);
+
+  /* the family's every size, which the font cache holds at once; what
+   * one costs is what a first use waits for */
+  uint64_t t0 = now_ns();
+  for (int i = 0; i < NUM_ZOOM_LEVELS; i++) {
+    snprintf(path, sizeof(path), "%s/font_%d_%d.bin", dir, g_font_family,
+             g_zoom_sizes[i]);
+    g_all_fonts[g_font_family][i] = tr_load_font(path);
+    if (!g_all_fonts[g_font_family][i]) {
+      fprintf(stderr, "cannot load %s\n", path);
+      return 1;
+    }
+  }
+  uint64_t load_ns = now_ns() - t0;
+  g_font = g_all_fonts[g_font_family][g_zoom_level];
+
+  prof_init();
+  tr_init_fb();
+  tr_init_fb_sub();
+  irqSet(IRQ_VBLANK, tr_vblank);
+
+  printf("%s, %d books\n", CORPUS_LABEL, g_num_books);
+  report("tr_load_font", NUM_ZOOM_LEVELS, load_ns);
+  bench_get_lines();
+  bench_page_turns();
+  bench_line_scroll();
+  bench_rows_index();
+  bench_warm_turns();
+  bench_hit_tests();
+  bench_lookups();
+  bench_search();
+  bench_browse();
+
+  reader_close(g_ctx);
+  return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <stdbool.h>
+
+bool nitroFSInit(const char *basepath);
@@ -0,0 +1,143 @@
+#pragma once
+
+/* the slice of libnds the reader uses, for building it on the host.
+ * registers and vram are plain memory in nds_host.c; nothing here tries
+ * to behave like the hardware beyond what the bench needs. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef volatile uint16_t vu16;
+typedef volatile uint32_t vu32;
+
+#define ITCM_CODE
+#define DTCM_DATA
+#define DTCM_BSS
+#define ARM_CODE
+#define BIT(n) (1u << (n))
+
+#define BUS_CLOCK 33513982
+#define timerTicks2usec(t) ((u32)(((uint64_t)(t) * 1000000) / BUS_CLOCK))
+#define timerTicks2msec(t) ((u32)(((uint64_t)(t) * 1000) / BUS_CLOCK))
+
+enum {
+  KEY_A = BIT(0),
+  KEY_B = BIT(1),
+  KEY_SELECT = BIT(2),
+  KEY_START = BIT(3),
+  KEY_RIGHT = BIT(4),
+  KEY_LEFT = BIT(5),
+  KEY_UP = BIT(6),
+  KEY_DOWN = BIT(7),
+  KEY_R = BIT(8),
+  KEY_L = BIT(9),
+  KEY_X = BIT(10),
+  KEY_Y = BIT(11),
+  KEY_TOUCH = BIT(12),
+};
+
+typedef struct {
+  u16 rawx, rawy, px, py, z1, z2;
+} touchPosition;
+
+void scanKeys(void);
+u32 keysDown(void);
+u32 keysHeld(void);
+u32 keysUp(void);
+u32 keysDownRepeat(void);
+void keysSetRepeat(u8 delay, u8 repeat);
+void touchRead(touchPosition *touch);
+
+enum { IRQ_VBLANK = BIT(0) };
+
+void irqSet(u32 mask, void (*handler)(void));
+void irqEnable(u32 mask);
+void swiWaitForVBlank(void);
+int enterCriticalSection(void);
+void leaveCriticalSection(int old);
+
+#define MODE_0_2D 0x10000
+#define MODE_5_2D 0x10005
+
+enum {
+  VRAM_A_MAIN_BG = 1,
+  VRAM_B_MAIN_BG = 1,
+  VRAM_C_SUB_BG = 4,
+  VRAM_A_MAIN_BG_0x06000000 = 1,
+  VRAM_B_MAIN_BG_0x06020000 = 1,
+  VRAM_D_MAIN_BG_0x06040000 = 1,
+  VRAM_C_SUB_BG_0x06200000 = 4,
+};
+
+typedef enum {
+  BgType_Text8bpp,
+  BgType_Text4bpp,
+  BgType_Rotation,
+  BgType_ExRotation,
+  BgType_Bmp8,
+  BgType_Bmp16,
+} BgType;
+
+typedef enum {
+  BgSize_R_128x128,
+  BgSize_T_256x256,
+  BgSize_T_512x256,
+  BgSize_T_256x512,
+  BgSize_B16_256x256,
+  BgSize_B16_512x256,
+  BgSize_B8_256x256,
+} BgSize;
+
+void videoSetMode(u32 mode);
+void videoSetModeSub(u32 mode);
+void vramSetBankA(int mode);
+void vramSetBankB(int mode);
+void vramSetBankC(int mode);
+void vramSetBankD(int mode);
+void lcdMainOnTop(void);
+
+int bgInit(int layer, BgType type, BgSize size, int map_base, int tile_base);
+int bgInitSub(int layer, BgType type, BgSize size, int map_base,
+              int tile_base);
+u16 *bgGetGfxPtr(int id);
+u16 *bgGetMapPtr(int id);
+void bgSetMapBase(int id, unsigned int base);
+void bgSetTileBase(int id, unsigned int base);
+void bgSetRotateScale(int id, int angle, int sx, int sy);
+void bgSetScroll(int id, int x, int y);
+void bgSetPriority(int id, unsigned int priority);
+void bgWrapOn(int id);
+void bgWrapOff(int id);
+void bgHide(int id);
+void bgShow(int id);
+void bgUpdate(void);
+
+extern u16 BG_PALETTE[256];
+extern u16 BG_PALETTE_SUB[256];
+
+void dmaCopyWords(u8 channel, const void *src, void *dst, u32 size);
+void dmaCopyHalfWords(u8 channel, const void *src, void *dst, u32 size);
+void dmaFillWords(u32 value, void *dst, u32 size);
+void dmaFillHalfWords(u16 value, void *dst, u32 size);
+void DC_FlushAll(void);
+void DC_FlushRange(const void *base, u32 size);
+void DC_InvalidateRange(const void *base, u32 size);
+
+void cpuStartTiming(int timer);
+u32 cpuGetTiming(void);
+u32 cpuEndTiming(void);
+
+typedef struct PrintConsole {
+  int unused;
+} PrintConsole;
+
+PrintConsole *consoleInit(PrintConsole *console, int layer, BgType type,
+                          BgSize size, int map_base, int tile_base,
+                          bool main_display, bool load_graphics);
+void defaultExceptionHandler(void);
@@ -0,0 +1,169 @@
+#include <nds.h>
+#include <fat.h>
+#include <filesystem.h>
+
+#include <string.h>
+#include <time.h>
+
+/* vram is plain memory; the bench reads it back only to keep the copies
+ * from being optimized away */
+
+enum {
+  MAIN_VRAM_HALFS = 256 * 1024 / 2,
+  SUB_VRAM_HALFS = 128 * 1024 / 2,
+  HOST_MAX_BGS = 8,
+};
+
+static u16 s_main_vram[MAIN_VRAM_HALFS];
+static u16 s_sub_vram[SUB_VRAM_HALFS];
+
+u16 BG_PALETTE[256];
+u16 BG_PALETTE_SUB[256];
+
+typedef struct {
+  u16 *vram;
+  BgType type;
+  int map_base;
+  int tile_base;
+} host_bg;
+
+static host_bg s_bgs[HOST_MAX_BGS];
+static int s_bg_count;
+
+static int add_bg(u16 *vram, BgType type, int map_base, int tile_base) {
+  int id = s_bg_count++ % HOST_MAX_BGS;
+  s_bgs[id] = (host_bg){vram, type, map_base, tile_base};
+  return id;
+}
+
+int bgInit(int layer, BgType type, BgSize size, int map_base, int tile_base) {
+  (void)layer;
+  (void)size;
+  return add_bg(s_main_vram, type, map_base, tile_base);
+}
+
+int bgInitSub(int layer, BgType type, BgSize size, int map_base,
+              int tile_base) {
+  (void)layer;
+  (void)size;
+  return add_bg(s_sub_vram, type, map_base, tile_base);
+}
+
+/* bitmaps are placed by map base in 16 KB steps, tiles by tile base */
+u16 *bgGetGfxPtr(int id) {
+  const host_bg *bg = &s_bgs[id];
+  int base = bg->type >= BgType_Bmp8 ? bg->map_base : bg->tile_base;
+  return bg->vram + base * 0x4000 / 2;
+}
+
+u16 *bgGetMapPtr(int id) {
+  return s_bgs[id].vram + s_bgs[id].map_base * 0x800 / 2;
+}
+
+void bgSetMapBase(int id, unsigned int base) { (void)id, (void)base; }
+void bgSetTileBase(int id, unsigned int base) { (void)id, (void)base; }
+void bgSetRotateScale(int id, int angle, int sx, int sy) {
+  (void)id, (void)angle, (void)sx, (void)sy;
+}
+void bgSetScroll(int id, int x, int y) { (void)id, (void)x, (void)y; }
+void bgSetPriority(int id, unsigned int priority) { (void)id, (void)priority; }
+void bgWrapOn(int id) { (void)id; }
+void bgWrapOff(int id) { (void)id; }
+void bgHide(int id) { (void)id; }
+void bgShow(int id) { (void)id; }
+void bgUpdate(void) {}
+
+void videoSetMode(u32 mode) { (void)mode; }
+void videoSetModeSub(u32 mode) { (void)mode; }
+void vramSetBankA(int mode) { (void)mode; }
+void vramSetBankB(int mode) { (void)mode; }
+void vramSetBankC(int mode) { (void)mode; }
+void vramSetBankD(int mode) { (void)mode; }
+void lcdMainOnTop(void) {}
+
+void dmaCopyWords(u8 channel, const void *src, void *dst, u32 size) {
+  (void)channel;
+  memcpy(dst, src, size);
+}
+
+void dmaCopyHalfWords(u8 channel, const void *src, void *dst, u32 size) {
+  (void)channel;
+  memcpy(dst, src, size);
+}
+
+void dmaFillWords(u32 value, void *dst, u32 size) {
+  u32 *p = dst;
+  for (u32 i = 0; i < size / 4; i++)
+    p[i] = value;
+}
+
+void dmaFillHalfWords(u16 value, void *dst, u32 size) {
+  u16 *p = dst;
+  for (u32 i = 0; i < size / 2; i++)
+    p[i] = value;
+}
+
+void DC_FlushAll(void) {}
+void DC_FlushRange(const void *base, u32 size) { (void)base, (void)size; }
+void DC_InvalidateRange(const void *base, u32 size) { (void)base, (void)size; }
+
+/* the bus clock is emulated from the monotonic clock, so profiler and
+ * bench numbers come out in host time scaled to ds ticks */
+static struct timespec s_timer_start;
+
+void cpuStartTiming(int timer) {
+  (void)timer;
+  clock_gettime(CLOCK_MONOTONIC, &s_timer_start);
+}
+
+u32 cpuGetTiming(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  int64_t ns = (now.tv_sec - s_timer_start.tv_sec) * 1000000000LL +
+               (now.tv_nsec - s_timer_start.tv_nsec);
+  return (u32)(ns * (BUS_CLOCK / 1000) / 1000000);
+}
+
+u32 cpuEndTiming(void) { return cpuGetTiming(); }
+
+/* each wait is one vblank: the registered handler runs right away */
+static void (*s_vblank)(void);
+
+void irqSet(u32 mask, void (*handler)(void)) {
+  if (mask & IRQ_VBLANK)
+    s_vblank = handler;
+}
+
+void irqEnable(u32 mask) { (void)mask; }
+
+void swiWaitForVBlank(void) {
+  if (s_vblank)
+    s_vblank();
+}
+
+int enterCriticalSection(void) { return 0; }
+void leaveCriticalSection(int old) { (void)old; }
+
+void scanKeys(void) {}
+u32 keysDown(void) { return 0; }
+u32 keysHeld(void) { return 0; }
+u32 keysUp(void) { return 0; }
+u32 keysDownRepeat(void) { return 0; }
+void keysSetRepeat(u8 delay, u8 repeat) { (void)delay, (void)repeat; }
+void touchRead(touchPosition *touch) { memset(touch, 0, sizeof(*touch)); }
+
+PrintConsole *consoleInit(PrintConsole *console, int layer, BgType type,
+                          BgSize size, int map_base, int tile_base,
+                          bool main_display, bool load_graphics) {
+  (void)layer, (void)type, (void)size, (void)map_base, (void)tile_base;
+  (void)main_display, (void)load_graphics;
+  return console;
+}
+
+void defaultExceptionHandler(void) {}
+
+bool fatInitDefault(void) { return false; }
+bool nitroFSInit(const char *basepath) {
+  (void)basepath;
+  return true;
+}
@@ -151,6 +151,7 @@ def create_schema(conn):
             work    TEXT NOT NULL,
             book    INTEGER NOT NULL,
             line    INTEGER NOT NULL,
+            cite    TEXT,
             greek   TEXT NOT NULL
         );
 
@@ -161,6 +162,15 @@ def create_schema(conn):
             postag  TEXT
         );
 
+        CREATE TABLE IF NOT EXISTS tokens (
+            id      INTEGER PRIMARY KEY AUTOINCREMENT,
+            book    INTEGER NOT NULL,
+            line    INTEGER NOT NULL,
+            form    TEXT NOT NULL,
+            lemma   TEXT NOT NULL,
+            postag  TEXT
+        );
+
         CREATE TABLE IF NOT EXISTS lexicon (
             id          INTEGER PRIMARY KEY AUTOINCREMENT,
             lemma       TEXT NOT NULL,
@@ -176,6 +186,7 @@ def create_indexes(conn):
         CREATE INDEX IF NOT EXISTS idx_texts_loc   ON texts(work, book, line);
         CREATE INDEX IF NOT EXISTS idx_morph_form  ON morphology(form);
         CREATE INDEX IF NOT EXISTS idx_morph_lemma ON morphology(lemma);
+        CREATE INDEX IF NOT EXISTS idx_tokens_loc  ON tokens(book, line);
         CREATE INDEX IF NOT EXISTS idx_lex_lemma   ON lexicon(lemma);
     """)
 
@@ -281,8 +292,8 @@ def import_verse(conn, work_name, xml_path):
             if not text:
                 continue
             cur.execute(
-                "INSERT INTO texts (work, book, line, greek) VALUES (?,?,?,?)",
-                (work_name, book_num, line_num, text),
+                "INSERT INTO texts (work, book, line, cite, greek) VALUES (?,?,?,?,?)",
+                (work_name, book_num, line_num, f"{book_num}.{line_num}", text),
             )
             count += 1
             last_book = max(last_book, book_num)
@@ -340,8 +351,9 @@ def import_prose(conn, work_name, xml_path):
                     continue
                 seq += 1
                 cur.execute(
-                    "INSERT INTO texts (work, book, line, greek) VALUES (?,?,?,?)",
-                    (work_name, book_num, seq, f"[{ch_num}.{sec_num}] {text}"),
+                    "INSERT INTO texts (work, book, line, cite, greek) VALUES (?,?,?,?,?)",
+                    (work_name, book_num, seq, f"{book_num}.{ch_num}.{sec_num}",
+                     f"[{ch_num}.{sec_num}] {text}"),
                 )
                 count += 1
                 last_book = max(last_book, book_num)
@@ -360,8 +372,18 @@ def import_texts(conn, work_name, structure, xml_path):
     return importers[structure](conn, work_name, xml_path)
 
 
-def import_morphology(conn, treebank_files):
-    """parse treebank XML → morphology table (form, lemma, postag)."""
+def cite_ref(urn):
+    """passage reference of a CTS urn or subdoc range: "…:1.5" -> "1.5",
+    "1.1-1.7" -> "1.1"."""
+    return urn.rsplit(":", 1)[-1].split("-", 1)[0].strip()
+
+
+def import_morphology(conn, work_name, treebank_files):
+    """parse treebank XML → morphology table (form, lemma, postag) and the
+    tokens table: every word in document order, placed on the text line
+    its citation names.  a word without its own cite takes its sentence's
+    subdoc, the first line the sentence touches; build_flatdb.py aligns
+    tokens against the line text, so that only needs to be a lower bound."""
     print("\n  Importing morphology...")
 
     if not treebank_files:
@@ -371,8 +393,11 @@ def import_morphology(conn, treebank_files):
     print(f"    Found {len(treebank_files)} treebank file(s)")
 
     cur = conn.cursor()
+    lines = {cite: (book, line) for book, line, cite in cur.execute(
+        "SELECT book, line, cite FROM texts WHERE work=?", (work_name,))}
     seen = set()
     count = 0
+    tokens = 0
 
     for fpath in treebank_files:
         try:
@@ -382,8 +407,12 @@ def import_morphology(conn, treebank_files):
             continue
 
         root = tree.getroot()
+        sent_loc = None
 
         for elem in root.iter():
+            if tag_local(elem) == "sentence":
+                sent_loc = lines.get(cite_ref(elem.get("subdoc") or ""))
+                continue
             if tag_local(elem) != "word":
                 continue
 
@@ -397,6 +426,15 @@ def import_morphology(conn, treebank_files):
             if postag and postag[0] == "u":
                 continue
 
+            loc = lines.get(cite_ref(elem.get("cite") or "")) or sent_loc
+            if loc:
+                cur.execute(
+                    "INSERT INTO tokens (book, line, form, lemma, postag) "
+                    "VALUES (?,?,?,?,?)",
+                    (loc[0], loc[1], form, lemma, postag or None),
+                )
+                tokens += 1
+
             key = (form, lemma, postag)
             if key in seen:
                 continue
@@ -410,6 +448,7 @@ def import_morphology(conn, treebank_files):
 
     conn.commit()
     print(f"    {count} unique analyses")
+    print(f"    {tokens} tokens placed on text lines")
     return count
 
 
@@ -552,7 +591,7 @@ def main():
         tb_cfg.get("repo", "treebank"),
         tb_cfg.get("pattern"),
     )
-    morphs = import_morphology(conn, treebank_files)
+    morphs = import_morphology(conn, work, treebank_files)
     lexent = import_lexicon(conn)
 
     print("\n  Pruning lexicon to MVP vocabulary...")
@@ -2,9 +2,9 @@
 """
 output binary format (all integers little-endian):
 
-  HEADER  (160 bytes)
+  HEADER  (196 bytes)
     magic[4]        "PRDB"
-    version         u32  = 1
+    version         u32  = 15
     num_texts       u32
     num_morphs      u32
     num_lex         u32
@@ -12,8 +12,49 @@ output binary format (all integers little-endian):
     text_idx_off    u32  — offset to text index
     morph_idx_off   u32  — offset to morph index
     lex_idx_off     u32  — offset to lex index
-    strings_off     u32  — offset to string pool
-    book_max[30]    u32 × 30  — max line per book (1-indexed)
+    strings_off     u32  — offset to compressed pool blocks
+    pool_size       u32  — decoded size of the string pool
+    num_blocks      u32
+    max_block       u32  — largest decoded block, in bytes
+    block_idx_off   u32  — offset to block index
+    form_hash_off   u32  — offset to form hash
+    num_slots       u32  — form hash slots, a few more than distinct forms
+    num_buckets     u32
+    hash_seed       u32
+    morph_key_off   u32  — offset to morph keys
+    lex_key_off     u32  — offset to lex keys
+    morph_lex_off   u32  — offset to morph lex links
+    num_tokens      u32
+    line_tok_off    u32  — offset to line tokens, past the postings
+    token_off       u32  — offset to tokens
+    book_tab_off    u32  — offset to book table
+    num_line_map    u32  — line map entries after the book table
+    fold_tab_off    u32  — offset to the fold table
+    num_fold        u32
+    fold_str_size   u32  — fold string bytes after the table
+    morph_norm_off  u32  — offset to the morph aliases of each tier
+    num_morph_norm  u32
+    morph_fold_off  u32
+    num_morph_fold  u32  — 0 if built with --no-fold
+    lex_norm_off    u32  — and the lex aliases
+    num_lex_norm    u32
+    lex_fold_off    u32
+    num_lex_fold    u32  — 0 if built with --no-fold
+    search_off      u32  — offset to the search terms
+    num_lemma_terms u32
+    num_form_terms  u32
+    postings_off    u32  — offset to the postings, past the string pool
+    postings_size   u32
+    term_key_off    u32  — offset to the search term keys
+    conc_off        u32  — offset to the concordance
+    conc_lines      u32  — occurrences kept per lemma, CONC_LINES
+    browse_off      u32  — offset to the lex browse index
+    num_browse      u32
+    browse_key_off  u32  — offset to its keys
+    browse_tier     u32  — lookup tier of its keys: 1 folded, 0 normalized
+                           when built with --no-fold
+
+  every section is present, if empty; the reader opens no other version.
 
   TEXT INDEX  (num_texts × 8 bytes, sorted by book, line)
     book            u16
@@ -30,41 +71,475 @@ output binary format (all integers little-endian):
     short_def_off   u32
     def_off         u32
 
+  BLOCK INDEX  ((num_blocks + 1) × 8 bytes, last entry is a sentinel)
+    pool_off        u32  — pool offset of the first byte in the block
+    data_off        u32  — offset of the stored block, from strings_off
+
+  FORM HASH  (num_buckets × 2 bytes, padded to 4, then num_slots × 4)
+    disp            u16  — per bucket displacement
+    first           u32  — morph index of the first entry with the form,
+                           0xFFFFFFFF for a spare slot
+
+    a perfect hash over the distinct forms (hash and displace).  a form
+    sits in bucket fastrange(mix32(fnv1a(form, seed)), num_buckets) and,
+    with h = fnv1a(form, ~seed), in slot
+    fastrange(mix32(h + PHI * (disp + 1)), num_slots), where
+    fastrange(x, n) = x * n >> 32.  a string that is not a form lands on
+    some slot too, so the reader compares the form it finds.
+
+  MORPH KEYS  (num_morphs × 8 bytes)
+  LEX KEYS    (num_lex × 8 bytes)
+    the first KEY_LEN bytes of each entry's form or lemma, zero padded, in
+    index order.  comparing them as bytes orders like strcmp, so a binary
+    search only reads the pool when a probe's key fills all eight bytes
+    and matches.
+
+  MORPH LEX LINKS  (num_morphs × 4 bytes)
+    lex_idx         u32  — lex index entry for the morph entry's lemma,
+                           0xFFFFFFFF if none
+
+    resolved the way the reader's lemma lookup would: the first entry with
+    the exact lemma, else the first of its normalized tier, else of its
+    folded tier (treebank lemmas are numbered, e.g. μῆνις1, and the
+    normalized key drops the number).
+
+  BOOK TABLE  ((num_books + 1) × 16 bytes, by book number from 0)
+    first           u32  — text index entry of the book's first line
+    count           u32  — lines in the book
+    min_line        u16
+    max_line        u16
+    map             u32  — first line map entry, 0xFFFFFFFF if the book's
+                           lines run min_line..max_line without gaps
+
+  LINE MAP  (num_line_map × 2 bytes, padded to 4)
+    pos             u16  — for each line number min_line..max_line of a
+                           book with gaps, the position within the book of
+                           the first line at or after it
+
+    with it book:line is a text index entry without a search: first +
+    line - min_line, or first + the line's map entry.
+
+  FOLD TABLE  (num_fold × 8 bytes, sorted by cp)
+    cp              u32
+    norm            u16  — offset into the fold strings of the codepoint's
+                           normalized spelling
+    fold            u16  — and of its folded spelling
+
+  FOLD STRINGS  (fold_str_size bytes, padded to 4)
+    null-terminated UTF-8; offset 0 is the empty string, which drops the
+    codepoint.
+
+    a lookup key is its string with every codepoint replaced by its
+    spellings here; codepoints not in the table stay as they are.  the
+    normalized tier decomposes (so NFC and NFD text agree), turns grave
+    accents acute and drops everything but letters and their marks:
+    punctuation, elision marks, digits.  the folded tier also drops the
+    marks and case, and spells final sigma as σ.
+
+  MORPH NORM  (num_morph_norm × 12 bytes)
+  MORPH FOLD  (num_morph_fold × 12 bytes)
+  LEX NORM    (num_lex_norm × 12 bytes)
+  LEX FOLD    (num_lex_fold × 12 bytes)
+    target          u32 × count  — morph or lex index entry
+    then the first KEY_LEN bytes of each target's key, as the morph and
+    lex keys
+
+    per tier, the entries whose key differs from their form or lemma,
+    sorted by (key bytes, target).  only the key prefixes are stored: the
+    reader spells a probe's form or lemma again when a prefix ties.  a
+    tier's matches for a key are the entries spelled like the key plus its
+    run here.  entries with an empty key or one over KEY_MAX bytes are
+    left out.
+
+  SEARCH TERMS  ((num_lemma_terms + num_form_terms) × 8 bytes)
+    key_off         u32  — offset into string pool of the term
+    post_off        u32  — its posting list, from postings_off
+
+    the lemma terms sorted by key bytes, then the form terms likewise.  a
+    lemma term is the normalized key of a lemma (see FOLD TABLE), a form
+    term that of a word of the text: a run of non-space characters, as a
+    tap picks it.  a word's lemmas are its tokens' where the treebank
+    covers it, else those of every analysis of its normalized form.
+    posting lists follow each other in term order, so a list ends where
+    the next term's begins.
+
+  TERM KEYS  ((num_lemma_terms + num_form_terms) × 8 bytes)
+    the first KEY_LEN bytes of each term, as the morph and lex keys.
+
+  CONCORDANCE  (num_lemma_terms × (4 + conc_lines × 8) bytes, in lemma
+                term order)
+    count           u32  — lines the lemma occurs in
+    then conc_lines times, for the first lines of its posting list:
+    text            u32  — text index entry, 0xFFFFFFFF past count
+    kwic_off        u32  — offset into string pool of the snippet
+
+    a snippet is the word the lemma was found in with up to KWIC_WORDS
+    words either side, "..." where the line goes on.  a lemma term's key
+    and its snippets are pooled together, unshared, so a lookup reads
+    them from the block its term search ended in.
+
+  LEX BROWSE  (num_browse × 4 bytes)
+    target          u32  — lex index entry
+
+    every lex entry with a key in browse_tier, sorted by (key bytes,
+    target): the entries whose key starts with a prefix are a run found
+    by two binary searches, however long it is.
+
+  BROWSE KEYS  (num_browse × 8 bytes)
+    the first KEY_LEN bytes of each browse entry's key, as the morph and
+    lex keys.  a prefix of up to KEY_LEN bytes is bounded without reading
+    the pool.
+
   STRING POOL
     null-terminated UTF-8 strings, concatenated.
     offset 0 is always the empty string "\\0".
+    string offsets are logical offsets into the decoded pool.  the pool is
+    cut into blocks of about BLOCK_SIZE bytes, never inside a string, and
+    each block is stored as an independent LZ4 block (raw block format, no
+    frame).  a block whose stored size equals its decoded size is stored
+    uncompressed.
+
+  POSTINGS  (postings_size bytes, after the string pool)
+    per term: the number of lines it occurs in, then the text index entry
+    of the first, then the gaps to each next one, all as varints: 7 bits a
+    byte, low bits first, the top bit set on every byte but the last.
+    they stay on the card; the reader reads one list per search.
+
+  LINE TOKENS  ((num_texts + 1) × 4 bytes after the postings, last entry
+               is a sentinel)
+    first           u32  — first token of the text index entry's line
+
+  TOKENS  (num_tokens × 8 bytes, by line, then by position)
+    start           u16  — byte offset of the word in the line text
+    len             u16  — its length in bytes
+    morph           u32  — morph index entry of the word's analysis here
+
+    the treebank's reading of each word in context.  tokens come from the
+    tokens table in document order and are matched against the line text
+    as whole words; a word that cannot be found is left out and taps on it
+    fall back to the form lookup.  empty when the database has no tokens
+    table.  like the postings they stay on the card: a tap reads its
+    line's two line token entries, then that line's run.
 """
 
+import re
 import sqlite3
 import struct
 import sys
 import os
+import unicodedata
+
+BLOCK_SIZE = 4096
+KEY_LEN    = 8
+KEY_MAX    = 127       # longest lookup key in bytes, as the reader's buffer
+
+TIER_NORM, TIER_FOLD = 0, 1
+GRAVE, ACUTE = "\u0300", "\u0301"
+
+# always in the fold table, whatever the database holds: what a keyboard
+# or a stray copy can put in a query
+FOLD_RANGES = [(0x20, 0x7F), (0xA0, 0x100), (0x2B0, 0x370), (0x370, 0x400),
+               (0x1F00, 0x2000), (0x2000, 0x2070)]
+
+TOKEN_LOOKAHEAD = 8        # lines a token may sit past its cited line
+
+CONC_LINES = 3             # occurrences kept per lemma for the lookup
+KWIC_WORDS = 3             # words of context either side of a snippet's
+KWIC_MAX   = 96            # longest snippet in bytes
+
+HASH_BUCKET_LOAD = 4       # forms per bucket on average
+HASH_SPARE_DIV   = 32      # one empty slot per this many forms
+HASH_MAX_DISP    = 0xFFFF
+HASH_PHI         = 0x9E3779B9
+M32              = 0xFFFFFFFF
+
+LZ4_MIN_MATCH   = 4
+LZ4_LAST_LITS   = 5    # the last 5 bytes of a block are always literals
+LZ4_MFLIMIT     = 12   # no match may start within 12 bytes of the end
+LZ4_MAX_OFFSET  = 0xFFFF
+
+
+def lz4_compress(src):
+    """greedy LZ4 block compressor (raw block, no frame)."""
+    out = bytearray()
+
+    def put_len(n):
+        while n >= 255:
+            out.append(255)
+            n -= 255
+        out.append(n)
+
+    def put_seq(lits, offset=0, mlen=0):
+        ml = mlen - LZ4_MIN_MATCH if offset else 0
+        out.append((min(len(lits), 15) << 4) | min(ml, 15))
+        if len(lits) >= 15:
+            put_len(len(lits) - 15)
+        out.extend(lits)
+        if offset:
+            out.extend(struct.pack("<H", offset))
+            if ml >= 15:
+                put_len(ml - 15)
+
+    n = len(src)
+    table = {}
+    anchor = 0
+    i = 0
+    while i < n - LZ4_MFLIMIT:
+        key = src[i:i + 4]
+        cand = table.get(key)
+        table[key] = i
+        if cand is None or i - cand > LZ4_MAX_OFFSET:
+            i += 1
+            continue
+        mlen = LZ4_MIN_MATCH
+        limit = n - LZ4_LAST_LITS - i
+        while mlen < limit and src[cand + mlen] == src[i + mlen]:
+            mlen += 1
+        put_seq(src[anchor:i], i - cand, mlen)
+        i += mlen
+        anchor = i
+    put_seq(src[anchor:])
+    return bytes(out)
+
+
+def key_prefix(s):
+    return (s or "").encode("utf-8")[:KEY_LEN].ljust(KEY_LEN, b"\x00")
+
+
+def fold_char(c):
+    """(normalized, folded) spelling of one codepoint"""
+    norm = []
+    for ch in unicodedata.normalize("NFD", c):
+        cat = unicodedata.category(ch)
+        if cat in ("Lu", "Ll", "Lt", "Lo"):
+            norm.append(ch)
+        elif cat == "Mn":
+            norm.append(ACUTE if ch == GRAVE else ch)
+    norm = "".join(norm)
+    fold = "".join(ch for ch in norm if unicodedata.category(ch) != "Mn")
+    return norm, fold.lower().replace("ς", "σ")
+
+
+def build_fold_table(strings):
+    """[(cp, norm, fold)] for every codepoint of FOLD_RANGES and `strings`
+    that some tier spells differently"""
+    cps = set()
+    for lo, hi in FOLD_RANGES:
+        cps.update(range(lo, hi))
+    for s in strings:
+        cps.update(ord(c) for c in s)
+    table = []
+    for cp in sorted(cps):
+        c = chr(cp)
+        norm, fold = fold_char(c)
+        if norm != c or fold != c:
+            table.append((cp, norm, fold))
+    return table
+
+
+def lookup_keys(s, spell):
+    """s's key bytes per tier, None where a tier has no key for it.
+    `spell` maps a codepoint to its (norm, fold) spellings"""
+    keys = []
+    for tier in (TIER_NORM, TIER_FOLD):
+        key = "".join(spell.get(c, (c, c))[tier] for c in s).encode("utf-8")
+        keys.append(key if key and len(key) <= KEY_MAX else None)
+    return keys
+
+
+def build_aliases(strings, keys):
+    """per tier, the (key, entry) of the entries whose key differs from
+    their string, sorted"""
+    tiers = []
+    for tier in (TIER_NORM, TIER_FOLD):
+        tiers.append(sorted(
+            (k[tier], i) for i, (s, k) in enumerate(zip(strings, keys))
+            if k[tier] is not None and k[tier] != s.encode("utf-8")))
+    return tiers
+
+
+def fnv1a(data, seed):
+    h = 2166136261 ^ seed
+    for b in data:
+        h = ((h ^ b) * 16777619) & M32
+    return h
+
+
+def mix32(h):
+    h ^= h >> 16
+    h = (h * 0x85EBCA6B) & M32
+    h ^= h >> 13
+    h = (h * 0xC2B2AE35) & M32
+    h ^= h >> 16
+    return h
+
+
+def fastrange(x, n):
+    return (x * n) >> 32
+
+
+def build_form_hash(keys):
+    """perfect hash over `keys` (distinct byte strings).  returns
+    (seed, disp, slots) where slots[i] is the position in `keys` of the key
+    that hashes to slot i, or -1.  a few spare slots keep the displacement
+    search short: with none, the last buckets hunt for the last free slots."""
+    n = len(keys) + len(keys) // HASH_SPARE_DIV + 1
+    num_buckets = max(1, (len(keys) + HASH_BUCKET_LOAD - 1) // HASH_BUCKET_LOAD)
+    for seed in range(1, 64):
+        # bucket and slot come from separately seeded hashes, so two forms
+        # only clash for good if both hashes collide
+        hashes = [fnv1a(k, seed ^ M32) for k in keys]
+        buckets = [[] for _ in range(num_buckets)]
+        for i, k in enumerate(keys):
+            buckets[fastrange(mix32(fnv1a(k, seed)), num_buckets)].append(i)
+
+        disp = [0] * num_buckets
+        slots = [-1] * n
+        ok = True
+        # biggest buckets first, while most slots are still free
+        for b in sorted(range(num_buckets), key=lambda b: -len(buckets[b])):
+            members = buckets[b]
+            if not members:
+                break
+            for d in range(HASH_MAX_DISP + 1):
+                step = (HASH_PHI * (d + 1)) & M32
+                pos = [fastrange(mix32((hashes[i] + step) & M32), n)
+                       for i in members]
+                if len(set(pos)) == len(pos) and all(slots[p] < 0 for p in pos):
+                    break
+            else:
+                ok = False
+                break
+            disp[b] = d
+            for i, p in zip(members, pos):
+                slots[p] = i
+        if ok:
+            return seed, disp, slots
+    raise RuntimeError("form hash: no seed worked")
+
+
+def build_book_table(text_entries, num_books):
+    """(first, count, min_line, max_line, map) per book number 0..num_books,
+    and the line map of the books whose numbering has gaps"""
+    books = []
+    line_map = []
+    i = 0
+    for b in range(num_books + 1):
+        first = i
+        while i < len(text_entries) and text_entries[i][0] == b:
+            i += 1
+        lines = [l for _, l, _ in text_entries[first:i]]
+        if not lines:
+            books.append((first, 0, 0, 0, M32))
+            continue
+        lo, hi = lines[0], lines[-1]
+        mp = M32
+        if len(lines) != hi - lo + 1:
+            mp = len(line_map)
+            pos = 0
+            for n in range(lo, hi + 1):
+                while lines[pos] < n:
+                    pos += 1
+                line_map.append(pos)
+        books.append((first, len(lines), lo, hi, mp))
+    return books, line_map
+
+
+def align_tokens(db, text_entries, line_texts, morph_id):
+    """per text index entry, the (start, len, morph) of each treebank token
+    found in its line.  a token's cited line is a lower bound: words cited
+    by sentence land on its first line, so the search walks forward from
+    the last match, a few lines at most."""
+    line_tokens = [[] for _ in text_entries]
+    if not db.execute("SELECT 1 FROM sqlite_master "
+                      "WHERE type='table' AND name='tokens'").fetchone():
+        return line_tokens, 0, 0
+
+    line_index = {(b, l): i for i, (b, l, _) in enumerate(text_entries)}
+    patterns = {}
+    cur, pos = -1, 0
+    found = missed = 0
+    for book, line, form, lemma, postag in db.execute(
+            "SELECT book, line, form, lemma, postag FROM tokens ORDER BY id"):
+        t = line_index.get((book, line))
+        m = morph_id.get((form or "", lemma or "", postag or ""))
+        if t is None or m is None:
+            missed += 1
+            continue
+        if t > cur:
+            cur, pos = t, 0
+        pat = patterns.get(form)
+        if pat is None:
+            pat = patterns[form] = re.compile(
+                r"(?<!\w)" + re.escape(form) + r"(?!\w)")
+        hit = None
+        for k in range(cur, min(cur + TOKEN_LOOKAHEAD, len(text_entries))):
+            if text_entries[k][0] != book:
+                break
+            hit = pat.search(line_texts[k], pos if k == cur else 0)
+            if hit:
+                break
+        if not hit:
+            missed += 1
+            continue
+        cur, pos = k, hit.end()
+        start = len(line_texts[k][:hit.start()].encode("utf-8"))
+        line_tokens[k].append((start, len(form.encode("utf-8")), m))
+        found += 1
+    return line_tokens, found, missed
+
+
+def kwic(words, i):
+    """the i-th of a line's words in its context, for the concordance"""
+    lo, hi = max(0, i - KWIC_WORDS), min(len(words), i + KWIC_WORDS + 1)
+    while True:
+        s = " ".join(words[lo:hi])
+        if lo:
+            s = "... " + s
+        if hi < len(words):
+            s += " ..."
+        if len(s.encode("utf-8")) <= KWIC_MAX or hi - lo == 1:
+            return s
+        # trim the longer side first
+        if i - lo > hi - 1 - i:
+            lo += 1
+        else:
+            hi -= 1
 
 
 def main():
     if len(sys.argv) < 3:
-        print(f"Usage: {sys.argv[0]} <input.db> <output.dat> [--skip-defs]")
+        print(f"Usage: {sys.argv[0]} <input.db> <output.dat> [--skip-defs] "
+              "[--no-fold]")
         sys.exit(1)
 
     db_path  = sys.argv[1]
     out_path = sys.argv[2]
     skip_defs = "--skip-defs" in sys.argv
+    no_fold = "--no-fold" in sys.argv
 
     db = sqlite3.connect(db_path)
 
     # ── string pool with deduplication ──────────────────────
     pool = bytearray(b"\x00")   # offset 0 = empty string
     seen = {"": 0}
+    block_starts = [0]
 
-    def intern(s):
-        """return the offset of `s` in the string pool, adding it if new."""
+    def intern(s, shared=True):
+        """return the offset of `s` in the string pool, adding it if new or
+        if not `shared`."""
         s = s or ""
-        if s in seen:
+        if shared and s in seen:
             return seen[s]
+        data = s.encode("utf-8") + b"\x00"
+        # strings never straddle a block, so the reader can hand out
+        # pointers into a single decoded block
+        fill = len(pool) - block_starts[-1]
+        if fill and fill + len(data) > BLOCK_SIZE:
+            block_starts.append(len(pool))
         off = len(pool)
-        seen[s] = off
-        pool.extend(s.encode("utf-8"))
-        pool.append(0)
+        seen.setdefault(s, off)
+        pool.extend(data)
         return off
 
     rows = db.execute(
@@ -72,16 +547,16 @@ def main():
     ).fetchall()
 
     text_entries = []
-    book_max = [0] * 30
+    line_texts = []
     max_book = 0
     for book, line, greek in rows:
         text_entries.append((book, line, intern(greek)))
-        if 1 <= book < 30:
-            book_max[book] = max(book_max[book], line)
+        line_texts.append(greek or "")
         max_book = max(max_book, book)
     num_books = max_book
 
     print(f"  texts:   {len(text_entries)} lines, {num_books} books")
+    books, line_map = build_book_table(text_entries, num_books)
 
     rows = db.execute(
         "SELECT form, lemma, postag FROM morphology"
@@ -90,7 +565,12 @@ def main():
     rows.sort(key=lambda r: (r[0] or "").encode("utf-8"))
 
     morph_entries = []
+    morph_keys = []
+    morph_forms = [r[0] or "" for r in rows]
+    morph_lemmas = [r[1] or "" for r in rows]
+    morph_id = {(f or "", l or "", p or ""): i for i, (f, l, p) in enumerate(rows)}
     for form, lemma, postag in rows:
+        morph_keys.append(key_prefix(form))
         morph_entries.append((
             intern(form  or ""),
             intern(lemma or ""),
@@ -99,6 +579,17 @@ def main():
 
     print(f"  morphs:  {len(morph_entries)} entries")
 
+    # entries are sorted by form, so each form's run starts at its first
+    form_keys, form_first = [], []
+    for i, r in enumerate(rows):
+        key = (r[0] or "").encode("utf-8")
+        if not form_keys or form_keys[-1] != key:
+            form_keys.append(key)
+            form_first.append(i)
+    hash_seed, hash_disp, hash_slots = build_form_hash(form_keys)
+    print(f"  forms:   {len(form_keys)} hashed into {len(hash_slots)} slots, "
+          f"{len(hash_disp)} buckets (seed {hash_seed})")
+
     rows = db.execute(
         "SELECT lemma, short_def, definition FROM lexicon"
     ).fetchall()
@@ -106,7 +597,9 @@ def main():
     rows.sort(key=lambda r: (r[0] or "").encode("utf-8"))
 
     lex_entries = []
+    lex_keys = []
     for lemma, short_def, definition in rows:
+        lex_keys.append(key_prefix(lemma))
         lex_entries.append((
             intern(lemma     or ""),
             intern(short_def or ""),
@@ -115,19 +608,203 @@ def main():
 
     print(f"  lexicon: {len(lex_entries)} entries")
 
+    # lookup keys: the fold table spells every form and lemma per tier
+    lemmas = [r[0] or "" for r in rows]
+    fold_table = build_fold_table(morph_forms + lemmas + line_texts +
+                                  morph_lemmas)
+    spell = {chr(cp): (norm, fold) for cp, norm, fold in fold_table}
+    morph_aliases = build_aliases(
+        morph_forms, [lookup_keys(f, spell) for f in morph_forms])
+    lex_aliases = build_aliases(
+        lemmas, [lookup_keys(l, spell) for l in lemmas])
+    if no_fold:
+        morph_aliases[TIER_FOLD] = lex_aliases[TIER_FOLD] = []
+    print(f"  fold:    {len(fold_table)} codepoints; aliases "
+          f"{len(morph_aliases[TIER_NORM])}+{len(morph_aliases[TIER_FOLD])} "
+          f"morph, {len(lex_aliases[TIER_NORM])}+"
+          f"{len(lex_aliases[TIER_FOLD])} lex")
+
+    lex_first = {}
+    for i, r in enumerate(rows):
+        lex_first.setdefault(r[0] or "", i)
+    browse_tier = TIER_NORM if no_fold else TIER_FOLD
+    browse = sorted((k[browse_tier], i) for i, k in
+                    enumerate(lookup_keys(l, spell) for l in lemmas)
+                    if k[browse_tier] is not None)
+
+    lex_alias_first = []
+    for tier in (TIER_NORM, TIER_FOLD):
+        first = {}
+        for key, i in lex_aliases[tier]:
+            first.setdefault(key, i)
+        lex_alias_first.append(first)
+
+    def lex_lookup(lemma):
+        """first entry of the reader's tiered lemma lookup, or None"""
+        idx = lex_first.get(lemma)
+        if idx is not None:
+            return idx
+        last = lemma.encode("utf-8")
+        for tier, key in enumerate(lookup_keys(lemma, spell)):
+            if key is None:
+                continue
+            if key != last and key.decode("utf-8") in lex_first:
+                return lex_first[key.decode("utf-8")]
+            if key in lex_alias_first[tier]:
+                return lex_alias_first[tier][key]
+            last = key
+        return None
+
+    morph_lex = []
+    for lemma in morph_lemmas:
+        idx = lex_lookup(lemma)
+        morph_lex.append(M32 if idx is None else idx)
+    linked = sum(1 for x in morph_lex if x != M32)
+    print(f"  links:   {linked}/{len(morph_lex)} morphs resolve to a lex entry")
+
+    line_tokens, found, missed = align_tokens(db, text_entries, line_texts,
+                                              morph_id)
+    num_tokens = sum(len(t) for t in line_tokens)
+    if found or missed:
+        print(f"  tokens:  {found} placed, {missed} not found in their lines")
+
+    # search postings: lines per lemma and per word form.  the keys go into
+    # the pool before it is compressed
+    form_lemmas = {}
+    for form, lemma in zip(morph_forms, morph_lemmas):
+        fk = lookup_keys(form, spell)[TIER_NORM]
+        lk = lookup_keys(lemma, spell)[TIER_NORM]
+        if fk and lk:
+            form_lemmas.setdefault(fk, set()).add(lk)
+    lemma_lines, form_lines = {}, {}
+    lemma_kwic = {}   # lemma key -> snippets of its first CONC_LINES lines
+
+    def post(lines, key, t):
+        run = lines.setdefault(key, [])
+        if run and run[-1] == t:
+            return False
+        run.append(t)
+        return True
+
+    def post_lemma(lk, t, words, i):
+        if post(lemma_lines, lk, t) and len(lemma_lines[lk]) <= CONC_LINES:
+            lemma_kwic.setdefault(lk, []).append(kwic(words, i))
+
+    for t, text in enumerate(line_texts):
+        words, spans = [], []
+        for w in re.finditer(r"\S+", text):
+            lo = len(text[:w.start()].encode("utf-8"))
+            words.append(w.group())
+            spans.append((lo, lo + len(w.group().encode("utf-8"))))
+        starts = [start for start, _, _ in line_tokens[t]]
+        for start, _, m in sorted(line_tokens[t]):
+            lk = lookup_keys(morph_lemmas[m], spell)[TIER_NORM]
+            if lk is None:
+                continue
+            i = next(i for i, (lo, hi) in enumerate(spans) if start < hi)
+            post_lemma(lk, t, words, i)
+        for i, (w, (lo, hi)) in enumerate(zip(words, spans)):
+            fk = lookup_keys(w, spell)[TIER_NORM]
+            if fk is None:
+                continue
+            post(form_lines, fk, t)
+            if any(lo <= st < hi for st in starts):
+                continue
+            for lk in sorted(form_lemmas.get(fk, ())):
+                post_lemma(lk, t, words, i)
+
+    def varint(n):
+        out = bytearray()
+        while n >= 0x80:
+            out.append(n & 0x7F | 0x80)
+            n >>= 7
+        out.append(n)
+        return out
+
+    postings = bytearray()
+    search_terms = []
+    term_keys = []
+    concordance = []
+    for lines in (lemma_lines, form_lines):
+        for key in sorted(lines):
+            run = lines[key]
+            # a lemma's own copy of its key heads its snippets: the compare
+            # that ends a term search loads the block they are in
+            lemma = lines is lemma_lines
+            key_off = intern(key.decode("utf-8"), shared=not lemma)
+            search_terms.append((key_off, len(postings)))
+            term_keys.append(key[:KEY_LEN].ljust(KEY_LEN, b"\x00"))
+            postings += varint(len(run))
+            prev = 0
+            for t in run:
+                postings += varint(t - prev)
+                prev = t
+            if lemma:
+                occ = [(t, intern(s, shared=False))
+                       for t, s in zip(run, lemma_kwic[key])]
+                occ += [(M32, 0)] * (CONC_LINES - len(occ))
+                concordance.append((len(run), occ))
+    print(f"  search:  {len(lemma_lines)} lemmas, {len(form_lines)} forms, "
+          f"{len(postings)} bytes of postings")
+
+    # compress the pool block by block
+    block_ends = block_starts[1:] + [len(pool)]
+    blocks = []
+    for start, end in zip(block_starts, block_ends):
+        raw = bytes(pool[start:end])
+        packed = lz4_compress(raw)
+        blocks.append(packed if len(packed) < len(raw) else raw)
+    max_block = max(e - s for s, e in zip(block_starts, block_ends))
+    packed_size = sum(len(b) for b in blocks)
+
+    # fold strings, each spelling once
+    fold_str = bytearray(b"\x00")
+    fold_off = {"": 0}
+    fold_entries = []
+    for cp, norm, fold in fold_table:
+        for sp in (norm, fold):
+            if sp not in fold_off:
+                fold_off[sp] = len(fold_str)
+                fold_str.extend(sp.encode("utf-8") + b"\x00")
+        fold_entries.append((cp, fold_off[norm], fold_off[fold]))
+    assert len(fold_str) <= 0xFFFF
+
     # section offsets
-    HEADER_SIZE   = 4 + 9 * 4 + 30 * 4   # 160 bytes
+    HEADER_SIZE   = 4 + 9 * 4 + 39 * 4  # 196 bytes
+    disp_size     = (len(hash_disp) * 2 + 3) & ~3
     text_idx_off  = HEADER_SIZE
     morph_idx_off = text_idx_off  + len(text_entries)  * 8
     lex_idx_off   = morph_idx_off + len(morph_entries)  * 12
-    strings_off   = lex_idx_off   + len(lex_entries)    * 12
+    block_idx_off = lex_idx_off   + len(lex_entries)    * 12
+    form_hash_off = block_idx_off + (len(blocks) + 1)   * 8
+    morph_key_off = form_hash_off + disp_size + len(hash_slots) * 4
+    lex_key_off   = morph_key_off + len(morph_keys) * KEY_LEN
+    morph_lex_off = lex_key_off   + len(lex_keys)   * KEY_LEN
+    book_tab_off  = morph_lex_off + len(morph_lex)  * 4
+    line_map_size = (len(line_map) * 2 + 3) & ~3
+    fold_tab_off  = book_tab_off  + len(books) * 16 + line_map_size
+    fold_str_size = (len(fold_str) + 3) & ~3
+    alias_offs    = []
+    off           = fold_tab_off  + len(fold_entries) * 8 + fold_str_size
+    for alias in morph_aliases + lex_aliases:
+        alias_offs.append(off)
+        off += len(alias) * (4 + KEY_LEN)
+    search_off    = off
+    term_key_off  = search_off    + len(search_terms) * 8
+    conc_off      = term_key_off  + len(search_terms) * KEY_LEN
+    browse_off    = conc_off      + len(concordance) * (4 + CONC_LINES * 8)
+    browse_key_off = browse_off   + len(browse) * 4
+    strings_off   = browse_key_off + len(browse) * KEY_LEN
+    postings_off  = strings_off   + packed_size
+    line_tok_off  = postings_off  + len(postings)
+    token_off     = line_tok_off  + (len(text_entries) + 1) * 4
 
     os.makedirs(os.path.dirname(out_path) or ".", exist_ok=True)
 
     with open(out_path, "wb") as f:
         # header
         f.write(b"PRDB")
-        f.write(struct.pack("<I", 1))                   # version
+        f.write(struct.pack("<I", 15))                  # version
         f.write(struct.pack("<I", len(text_entries)))   # num_texts
         f.write(struct.pack("<I", len(morph_entries)))  # num_morphs
         f.write(struct.pack("<I", len(lex_entries)))    # num_lex
@@ -136,8 +813,39 @@ def main():
         f.write(struct.pack("<I", morph_idx_off))
         f.write(struct.pack("<I", lex_idx_off))
         f.write(struct.pack("<I", strings_off))
-        for i in range(30):
-            f.write(struct.pack("<I", book_max[i]))
+        f.write(struct.pack("<I", len(pool)))
+        f.write(struct.pack("<I", len(blocks)))
+        f.write(struct.pack("<I", max_block))
+        f.write(struct.pack("<I", block_idx_off))
+        f.write(struct.pack("<I", form_hash_off))
+        f.write(struct.pack("<I", len(hash_slots)))     # num_slots
+        f.write(struct.pack("<I", len(hash_disp)))      # num_buckets
+        f.write(struct.pack("<I", hash_seed))
+        f.write(struct.pack("<I", morph_key_off))
+        f.write(struct.pack("<I", lex_key_off))
+        f.write(struct.pack("<I", morph_lex_off))
+        f.write(struct.pack("<I", num_tokens))
+        f.write(struct.pack("<I", line_tok_off))
+        f.write(struct.pack("<I", token_off))
+        f.write(struct.pack("<I", book_tab_off))
+        f.write(struct.pack("<I", len(line_map)))
+        f.write(struct.pack("<I", fold_tab_off))
+        f.write(struct.pack("<I", len(fold_entries)))   # num_fold
+        f.write(struct.pack("<I", fold_str_size))
+        for alias, aoff in zip(morph_aliases + lex_aliases, alias_offs):
+            f.write(struct.pack("<II", aoff, len(alias)))
+        f.write(struct.pack("<I", search_off))
+        f.write(struct.pack("<I", len(lemma_lines)))    # num_lemma_terms
+        f.write(struct.pack("<I", len(form_lines)))     # num_form_terms
+        f.write(struct.pack("<I", postings_off))
+        f.write(struct.pack("<I", len(postings)))       # postings_size
+        f.write(struct.pack("<I", term_key_off))
+        f.write(struct.pack("<I", conc_off))
+        f.write(struct.pack("<I", CONC_LINES))          # conc_lines
+        f.write(struct.pack("<I", browse_off))
+        f.write(struct.pack("<I", len(browse)))         # num_browse
+        f.write(struct.pack("<I", browse_key_off))
+        f.write(struct.pack("<I", browse_tier))
         assert f.tell() == HEADER_SIZE
 
         # text index
@@ -153,18 +861,104 @@ def main():
         # lex index
         for loff, soff, doff in lex_entries:
             f.write(struct.pack("<III", loff, soff, doff))
+        assert f.tell() == block_idx_off
+
+        # block index
+        data_off = 0
+        for start, packed in zip(block_starts, blocks):
+            f.write(struct.pack("<II", start, data_off))
+            data_off += len(packed)
+        f.write(struct.pack("<II", len(pool), data_off))
+        assert f.tell() == form_hash_off
+
+        # form hash
+        for d in hash_disp:
+            f.write(struct.pack("<H", d))
+        f.write(b"\x00" * (disp_size - len(hash_disp) * 2))
+        for k in hash_slots:
+            f.write(struct.pack("<I", form_first[k] if k >= 0 else M32))
+        assert f.tell() == morph_key_off
+
+        # key prefixes
+        f.write(b"".join(morph_keys))
+        assert f.tell() == lex_key_off
+        f.write(b"".join(lex_keys))
+        assert f.tell() == morph_lex_off
+
+        # morph lex links
+        for idx in morph_lex:
+            f.write(struct.pack("<I", idx))
+        assert f.tell() == book_tab_off
+
+        # book table and line map
+        for first, count, lo, hi, mp in books:
+            f.write(struct.pack("<IIHHI", first, count, lo, hi, mp))
+        for pos in line_map:
+            f.write(struct.pack("<H", pos))
+        f.write(b"\x00" * (line_map_size - len(line_map) * 2))
+        assert f.tell() == fold_tab_off
+
+        # fold table and its strings, then the aliases of each tier
+        # and their key prefixes
+        for cp, norm, fold in fold_entries:
+            f.write(struct.pack("<IHH", cp, norm, fold))
+        f.write(fold_str)
+        f.write(b"\x00" * (fold_str_size - len(fold_str)))
+        for alias in morph_aliases + lex_aliases:
+            for _, i in alias:
+                f.write(struct.pack("<I", i))
+            for key, _ in alias:
+                f.write(key[:KEY_LEN].ljust(KEY_LEN, b"\x00"))
+        assert f.tell() == search_off
+
+        # search terms
+        for key_off, post_off in search_terms:
+            f.write(struct.pack("<II", key_off, post_off))
+        assert f.tell() == term_key_off
+        f.write(b"".join(term_keys))
+        assert f.tell() == conc_off
+
+        # concordance
+        for count, occ in concordance:
+            f.write(struct.pack("<I", count))
+            for t, kwic_off in occ:
+                f.write(struct.pack("<II", t, kwic_off))
+        assert f.tell() == browse_off
+
+        # lex browse index and its keys
+        for _, i in browse:
+            f.write(struct.pack("<I", i))
+        assert f.tell() == browse_key_off
+        for key, _ in browse:
+            f.write(key[:KEY_LEN].ljust(KEY_LEN, b"\x00"))
         assert f.tell() == strings_off
 
-        # string pool
-        f.write(bytes(pool))
-
-    total = strings_off + len(pool)
+        # string pool, then the postings
+        for packed in blocks:
+            f.write(packed)
+        assert f.tell() == postings_off
+        f.write(postings)
+        assert f.tell() == line_tok_off
+
+        # line tokens, then the tokens themselves
+        first = 0
+        for toks in line_tokens:
+            f.write(struct.pack("<I", first))
+            first += len(toks)
+        f.write(struct.pack("<I", first))
+        for toks in line_tokens:
+            for start, length, m in toks:
+                f.write(struct.pack("<HHI", start, length, m))
+
+    total = postings_off + len(postings)
     print()
     print(f"Generated {out_path}")
     print(f"  Texts:    {len(text_entries):>6}")
     print(f"  Morphs:   {len(morph_entries):>6}")
     print(f"  Lexicon:  {len(lex_entries):>6}")
     print(f"  Strings:  {len(pool):>6} bytes  ({len(seen)} unique)")
+    print(f"  Packed:   {packed_size:>6} bytes  ({len(blocks)} blocks, "
+          f"{100 * packed_size / len(pool):.0f}%)")
     print(f"  Total:    {total:>6} bytes  ({total / 1024 / 1024:.2f} MB)")
     if skip_defs:
         print("  (full definitions skipped)")
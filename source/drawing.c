@@ -156,6 +156,7 @@ void draw_render_overlay(int cur_book, int cur_zoom, const draw_line_map_t *map,
   if (map_count == 0)
     return;
 
+  prof_begin(PROF_OVERLAY);
   for (int i = 0; i < g_draw_stroke_count; i++) {
     draw_stroke_t *s = &g_draw_strokes[i];
     if (s->book != cur_book || s->zoom != cur_zoom)
@@ -166,7 +167,7 @@ void draw_render_overlay(int cur_book, int cur_zoom, const draw_line_map_t *map,
     if (s->count == 1) {
       draw_point_t *p = &g_draw_pool[s->start];
       int sy = line_to_screen(map, map_count, p->line, p->y_off);
-      if (sy >= 0 && sy < TR_SCREEN_H)
+      if (sy > DRAW_OFF_SCREEN + 1000)
         tr_draw_pixel(p->x, sy, color);
       continue;
     }
@@ -185,15 +186,16 @@ void draw_render_overlay(int cur_book, int cur_zoom, const draw_line_map_t *map,
       prev_vis = cur_vis;
     }
   }
+  prof_end(PROF_OVERLAY);
 }
 
 void draw_show_indicator(void) {
   tr_select(TR_SCREEN_BOTTOM);
   const palette_t *p = active_palette();
-  int h = g_fonts[0]->glyph_h + 2;
+  int h = ui_font(0)->glyph_h + 2;
   int y = TR_SCREEN_H - h;
   tr_fill_rect(0, y, TR_SCREEN_W, h, p->hl);
-  tr_draw_text(g_fonts[0], 2, y + 1, "[X] done  [Y] clear", p->bg);
+  tr_draw_text(ui_font(0), 2, y + 1, "[X] done  [Y] clear", p->bg);
 }
 
 void draw_clear_view(int cur_book, int cur_line, int cur_zoom) {
@@ -146,6 +146,43 @@ static const kb_key_t latin_upper[] = {
 
 #define NUM_LATIN_KEYS ((int)countof(latin_lower))
 
+/* the modern greek layout; lookups fold case and diacritics, so there is
+ * no shift and no accent key */
+static const kb_key_t greek_keys[] = {
+    {LCOL(LR1X, 0), LROW(0), LKW, LKH, "\xcf\x82", 0, 0},
+    {LCOL(LR1X, 1), LROW(0), LKW, LKH, "\xce\xb5", 0, 0},
+    {LCOL(LR1X, 2), LROW(0), LKW, LKH, "\xcf\x81", 0, 0},
+    {LCOL(LR1X, 3), LROW(0), LKW, LKH, "\xcf\x84", 0, 0},
+    {LCOL(LR1X, 4), LROW(0), LKW, LKH, "\xcf\x85", 0, 0},
+    {LCOL(LR1X, 5), LROW(0), LKW, LKH, "\xce\xb8", 0, 0},
+    {LCOL(LR1X, 6), LROW(0), LKW, LKH, "\xce\xb9", 0, 0},
+    {LCOL(LR1X, 7), LROW(0), LKW, LKH, "\xce\xbf", 0, 0},
+    {LCOL(LR1X, 8), LROW(0), LKW, LKH, "\xcf\x80", 0, 0},
+    {LCOL(LR1X, 0), LROW(1), LKW, LKH, "\xce\xb1", 0, 0},
+    {LCOL(LR1X, 1), LROW(1), LKW, LKH, "\xcf\x83", 0, 0},
+    {LCOL(LR1X, 2), LROW(1), LKW, LKH, "\xce\xb4", 0, 0},
+    {LCOL(LR1X, 3), LROW(1), LKW, LKH, "\xcf\x86", 0, 0},
+    {LCOL(LR1X, 4), LROW(1), LKW, LKH, "\xce\xb3", 0, 0},
+    {LCOL(LR1X, 5), LROW(1), LKW, LKH, "\xce\xb7", 0, 0},
+    {LCOL(LR1X, 6), LROW(1), LKW, LKH, "\xce\xbe", 0, 0},
+    {LCOL(LR1X, 7), LROW(1), LKW, LKH, "\xce\xba", 0, 0},
+    {LCOL(LR1X, 8), LROW(1), LKW, LKH, "\xce\xbb", 0, 0},
+    {LR2X + LKW + 6 + LGP, LROW(2), LKW, LKH, "\xce\xb6", 0, 0},
+    {LCOL(LR2X + LKW + 6 + LGP, 1), LROW(2), LKW, LKH, "\xcf\x87", 0, 0},
+    {LCOL(LR2X + LKW + 6 + LGP, 2), LROW(2), LKW, LKH, "\xcf\x88", 0, 0},
+    {LCOL(LR2X + LKW + 6 + LGP, 3), LROW(2), LKW, LKH, "\xcf\x89", 0, 0},
+    {LCOL(LR2X + LKW + 6 + LGP, 4), LROW(2), LKW, LKH, "\xce\xb2", 0, 0},
+    {LCOL(LR2X + LKW + 6 + LGP, 5), LROW(2), LKW, LKH, "\xce\xbd", 0, 0},
+    {LCOL(LR2X + LKW + 6 + LGP, 6), LROW(2), LKW, LKH, "\xce\xbc", 0, 0},
+    {256 - LKW - 6 - LGP, LROW(2), LKW + 6, LKH, "\xe2\x86\x90", 0,
+     KB_ACT_BACKSPACE},
+    {4, LROW(3), 28, LKH, "X", 0, KB_ACT_CANCEL},
+    {36, LROW(3), 160, LKH, " ", 0, KB_ACT_SPACE},
+    {200, LROW(3), 52, LKH, "Done", 0, KB_ACT_DONE},
+};
+
+#define NUM_GREEK_KEYS ((int)countof(greek_keys))
+
 static void get_layout(const kb_key_t **out_keys, int *out_count) {
   switch (g_kb.mode) {
   case KB_MODE_GOTO:
@@ -156,6 +193,11 @@ static void get_layout(const kb_key_t **out_keys, int *out_count) {
     *out_keys = g_kb.shift ? latin_upper : latin_lower;
     *out_count = NUM_LATIN_KEYS;
     break;
+  case KB_MODE_GREEK:
+  case KB_MODE_DICT:
+    *out_keys = greek_keys;
+    *out_count = NUM_GREEK_KEYS;
+    break;
   default:
     *out_keys = goto_keys;
     *out_count = NUM_GOTO_KEYS;
@@ -207,7 +249,7 @@ void kb_draw(void) {
   tr_select(TR_SCREEN_BOTTOM);
   tr_clear(bg);
 
-  tr_font *tf = g_fonts[2];
+  tr_font *tf = ui_font(2);
 
   int field_y = 4;
   int field_rows = (g_kb.mode == KB_MODE_LATIN) ? 3 : 2;
@@ -228,6 +270,9 @@ void kb_draw(void) {
   case KB_MODE_GOTO:
     mode_label = "Hom. Il. ";
     break;
+  case KB_MODE_DICT:
+    mode_label = "Lex:";
+    break;
   }
   tr_draw_text(tf, 8, field_y + 4, mode_label, dim);
   int label_w = tr_text_width(tf, mode_label);
@@ -270,7 +315,7 @@ void kb_draw(void) {
       tr_fill_rect(k->x + k->w - 1, row, 1, 1, dim);
     }
 
-    tr_font *lf = (g_kb.mode == KB_MODE_GOTO) ? g_fonts[3] : g_fonts[2];
+    tr_font *lf = (g_kb.mode == KB_MODE_GOTO) ? ui_font(3) : ui_font(2);
     int tw = tr_text_width(lf, k->label);
     int tx = k->x + (k->w - tw) / 2;
     int ty = k->y + (k->h - lf->glyph_h) / 2;
@@ -328,6 +373,8 @@ kb_result_t kb_touch(int tx, int ty) {
         }
       }
       kb_draw();
+      if (g_kb.mode == KB_MODE_DICT)
+        browse_run();
       break;
     }
   }
@@ -393,6 +440,9 @@ static app_state_t kb_confirm_and_return(void) {
     return ST_LOOKUP;
   }
 
+  if (g_kb.mode == KB_MODE_DICT)
+    return browse_open();
+
   show_text();
   return ST_READ;
 }
@@ -8,6 +8,7 @@ typedef enum {
   KB_MODE_GREEK,
   KB_MODE_LATIN,
   KB_MODE_GOTO,
+  KB_MODE_DICT, /* greek keys; the lexicon is browsed as you type */
 } kb_mode_t;
 
 typedef enum {
@@ -15,16 +15,105 @@ void result_push(const char *text, uint16_t color, int indent) {
 }
 #pragma GCC diagnostic pop
 
-void build_lookup_result(const char *word, int dict_mode) {
+/* what X searches for from the lookup screen: the first reading's lemma,
+ * or failing that the word as it was tapped */
+static char s_find_lemma[MAX_WORD_LEN];
+static char s_find_form[MAX_WORD_LEN];
+
+static struct {
+  int kind;
+  int total; /* lines the word occurs in */
+  int count; /* of them in hits */
+  int cursor;
+  int scroll;
+  reader_pos hits[MAX_SEARCH_HITS];
+  /* the text of the hits last drawn, hit i in slot i % MAX_SEARCH_ROWS:
+   * moving the cursor reads nothing, a scroll only the rows it brings in */
+  int row_hit[MAX_SEARCH_ROWS];
+  char row_text[MAX_SEARCH_ROWS][MAX_RESULT_LEN];
+} s_search;
+
+static void find_set(const char *form, const char *lemma) {
+  snprintf(s_find_form, sizeof(s_find_form), "%s", form);
+  snprintf(s_find_lemma, sizeof(s_find_lemma), "%s", lemma);
+}
+
+static void result_begin(const char *title) {
   g_result_count = 0;
   g_result_scroll = 0;
-  strncpy(g_result_title, word, MAX_WORD_LEN - 1);
+  strncpy(g_result_title, title, MAX_WORD_LEN - 1);
   g_result_title[MAX_WORD_LEN - 1] = '\0';
+}
+
+/* with in_context set the first analysis is the reading of the tapped
+ * token and the rest are set off below it */
+static void push_analyses(const reader_morph *morphs, int nm,
+                          int in_context) {
+  for (int i = 0; i < nm; i++) {
+    if (in_context && i == 1)
+      result_push("--- Other readings ---", active_palette()->num, 4);
+    char buf[MAX_RESULT_LEN];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+    snprintf(buf, sizeof(buf), "%s -> %s", morphs[i].form, morphs[i].lemma);
+#pragma GCC diagnostic pop
+    result_push(buf, active_palette()->hl, 4);
+    reader_format_postag(morphs[i].postag, buf, sizeof(buf));
+    result_push(buf, active_palette()->hl, 12);
+
+    reader_lex_entry lex;
+    if (reader_morph_lex(g_ctx, &morphs[i], &lex) > 0 && lex.short_def[0])
+      result_push(lex.short_def, active_palette()->text, 12);
+    result_push("", active_palette()->bg, 0);
+  }
+}
+
+/* where the first reading's lemma occurs across the corpus */
+static void push_occurrences(void) {
+  reader_occurrence occ[MAX_OCCURRENCES];
+  int total;
+  if (!s_find_lemma[0])
+    return;
+  int n = reader_concordance(g_ctx, s_find_lemma, occ, MAX_OCCURRENCES,
+                             &total);
+  if (n <= 0)
+    return;
+
+  char buf[MAX_RESULT_LEN];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+  snprintf(buf, sizeof(buf), "--- Occurrences: %d line%s ---", total,
+           total == 1 ? "" : "s");
+  result_push(buf, active_palette()->num, 4);
+  for (int i = 0; i < n; i++) {
+    snprintf(buf, sizeof(buf), "%d.%d  %s", occ[i].pos.book, occ[i].pos.line,
+             occ[i].kwic);
+    result_push(buf, active_palette()->text, 8);
+  }
+#pragma GCC diagnostic pop
+  result_push("", active_palette()->bg, 0);
+}
+
+static void push_note(void) {
+  const char *note = notes_find(g_result_title);
+  if (note) {
+    result_push("--- Note ---", active_palette()->num, 4);
+    result_push(note, active_palette()->hl, 8);
+  }
+}
+
+/* everything the reader hands out here is a view into the lookup frame;
+ * result_push copies it before the next lookup releases the frame */
+void build_lookup_result(const char *word, int dict_mode) {
+  prof_begin(PROF_LOOKUP);
+  reader_frame(g_ctx, READER_FRAME_LOOKUP);
+  result_begin(word);
 
   if (dict_mode) {
-    static reader_lex_entry entries[4];
+    reader_lex_entry entries[4];
     int n = reader_lex_lookup(g_ctx, word, entries, 4);
 
+    find_set(word, n > 0 ? entries[0].lemma : "");
     if (n > 0) {
       for (int i = 0; i < n; i++) {
         result_push(entries[i].lemma, active_palette()->hl, 4);
@@ -33,17 +122,17 @@ void build_lookup_result(const char *word, int dict_mode) {
         result_push("", active_palette()->bg, 0);
       }
     } else {
-      static reader_morph morphs[8];
+      reader_morph morphs[8];
       int nm = reader_morph_lookup(g_ctx, word, morphs, 8);
       if (nm > 0) {
         for (int i = 0; i < nm; i++) {
-          n = reader_lex_lookup(g_ctx, morphs[i].lemma, entries, 1);
+          n = reader_morph_lex(g_ctx, &morphs[i], entries);
           if (n > 0) {
-            char buf[MAX_RESULT_LEN];
+            char parse[MAX_RESULT_LEN], buf[MAX_RESULT_LEN];
+            reader_format_postag(morphs[i].postag, parse, sizeof(parse));
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-truncation"
-            snprintf(buf, sizeof(buf), "%s (%s)", entries[0].lemma,
-                     morphs[i].parse_str);
+            snprintf(buf, sizeof(buf), "%s (%s)", entries[0].lemma, parse);
 #pragma GCC diagnostic pop
             result_push(buf, active_palette()->hl, 4);
             if (entries[0].short_def[0])
@@ -58,37 +147,46 @@ void build_lookup_result(const char *word, int dict_mode) {
       }
     }
   } else {
-    static reader_morph morphs[8];
+    reader_morph morphs[8];
     int nm = reader_morph_lookup(g_ctx, word, morphs, 8);
+    find_set(word, nm > 0 ? morphs[0].lemma : "");
 
     if (nm == 0) {
       char buf[MAX_RESULT_LEN];
       snprintf(buf, sizeof(buf), "No data for: %s", word);
       result_push(buf, active_palette()->num, 4);
     } else {
-      for (int i = 0; i < nm; i++) {
-        char buf[MAX_RESULT_LEN];
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wformat-truncation"
-        snprintf(buf, sizeof(buf), "%s -> %s", morphs[i].form, morphs[i].lemma);
-#pragma GCC diagnostic pop
-        result_push(buf, active_palette()->hl, 4);
-        result_push(morphs[i].parse_str, active_palette()->hl, 12);
-
-        static reader_lex_entry lex[1];
-        int nl = reader_lex_lookup(g_ctx, morphs[i].lemma, lex, 1);
-        if (nl > 0 && lex[0].short_def[0])
-          result_push(lex[0].short_def, active_palette()->text, 12);
-        result_push("", active_palette()->bg, 0);
-      }
+      push_analyses(morphs, nm, 0);
     }
   }
 
-  const char *note = notes_find(word);
-  if (note) {
-    result_push("--- Note ---", active_palette()->num, 4);
-    result_push(note, active_palette()->hl, 8);
+  push_occurrences();
+  push_note();
+  prof_end(PROF_LOOKUP);
+}
+
+/* a tap resolves through the token under it: no string search, the
+ * punctuation around the word does not matter and the reading in context
+ * comes first.  words the treebank does not cover fall back to the form
+ * lookup */
+void build_tap_result(const tap_word *tap) {
+  reader_morph morphs[8];
+  prof_begin(PROF_LOOKUP);
+  reader_frame(g_ctx, READER_FRAME_LOOKUP);
+  int nm = reader_token_lookup(g_ctx, tap->book, tap->line, tap->off,
+                               (int)strlen(tap->word), morphs,
+                               (int)countof(morphs));
+  if (nm > 0) {
+    find_set(tap->word, morphs[0].lemma);
+    /* the title keys the notes: the word as tapped, like every lookup */
+    result_begin(tap->word);
+    push_analyses(morphs, nm, 1);
+    push_occurrences();
+    push_note();
   }
+  prof_end(PROF_LOOKUP);
+  if (nm == 0)
+    build_lookup_result(tap->word, 0);
 }
 
 void draw_lookup_result(void) {
@@ -120,7 +218,7 @@ void draw_lookup_result(void) {
 
   int footer_y = TR_SCREEN_H - g_font->glyph_h - 2;
   tr_draw_hline(0, footer_y - 2, TR_SCREEN_W, p->num);
-  tr_draw_text(g_font, 4, footer_y, "[B] back  [Y] note  Up/Dn scroll", p->hl);
+  tr_draw_text(g_font, 4, footer_y, "[B] back [X] find [Y] note Up/Dn", p->hl);
 
   tr_flip();
 }
@@ -129,9 +227,9 @@ void draw_lookup_result(void) {
 app_state_t on_lookup_TOUCH(app_state_t s) {
   touchPosition touch;
   touchRead(&touch);
-  char tapped_word[MAX_WORD_LEN];
-  if (touch_to_word(touch.px, touch.py, tapped_word, MAX_WORD_LEN)) {
-    build_lookup_result(tapped_word, 0);
+  tap_word tap;
+  if (touch_to_word(touch.px, touch.py, &tap)) {
+    build_tap_result(&tap);
     draw_lookup_result();
   }
   return s;
@@ -168,3 +266,275 @@ app_state_t on_lookup_Y(app_state_t s) {
   kb_draw();
   return ST_KB_LATIN;
 }
+
+
+static void run_search(int kind) {
+  prof_begin(PROF_LOOKUP);
+  s_search.kind = kind;
+  s_search.total =
+      reader_search(g_ctx, kind,
+                    kind == READER_SEARCH_LEMMA ? s_find_lemma : s_find_form,
+                    s_search.hits, MAX_SEARCH_HITS);
+  s_search.count =
+      s_search.total > MAX_SEARCH_HITS ? MAX_SEARCH_HITS : s_search.total;
+  s_search.cursor = 0;
+  s_search.scroll = 0;
+  for (int i = 0; i < MAX_SEARCH_ROWS; i++)
+    s_search.row_hit[i] = -1;
+  prof_end(PROF_LOOKUP);
+}
+
+static int search_rows(void) {
+  int line_h = g_font->glyph_h + 1;
+  int rows = (TR_SCREEN_H - (line_h + 2) - (line_h + 4)) / line_h;
+  return rows < MAX_SEARCH_ROWS ? rows : MAX_SEARCH_ROWS;
+}
+
+/* hit i's line, cut at a character within MAX_RESULT_LEN bytes */
+static const char *search_row_text(int i) {
+  int slot = i % MAX_SEARCH_ROWS;
+  char *text = s_search.row_text[slot];
+  if (s_search.row_hit[slot] == i)
+    return text;
+  const reader_pos *h = &s_search.hits[i];
+  reader_line ln;
+  size_t n = 0;
+  if (reader_scan_lines(g_ctx, CORPUS_WORK, h->book, h->line, 1, &ln) == 1 &&
+      ln.line == h->line) {
+    n = strlen(ln.text);
+    if (n >= MAX_RESULT_LEN) {
+      n = MAX_RESULT_LEN - 1;
+      while (n > 0 && (ln.text[n] & 0xC0) == 0x80)
+        n--;
+    }
+    memcpy(text, ln.text, n);
+  }
+  text[n] = '\0';
+  /* hits are far apart: a row's block is done with once it is copied */
+  reader_frame(g_ctx, READER_FRAME_SCAN);
+  s_search.row_hit[slot] = i;
+  return text;
+}
+
+/* one row per line the word occurs in, its text cut off at the screen
+ * edge; only rows not on screen last time are read */
+void draw_search_result(void) {
+  const palette_t *p = active_palette();
+  tr_select(TR_SCREEN_TOP);
+  tr_clear(p->bg);
+
+  int line_h = g_font->glyph_h + 1;
+  int header_h = line_h + 2;
+  int rows = search_rows();
+  int lemma = s_search.kind == READER_SEARCH_LEMMA;
+  const char *word = lemma ? s_find_lemma : s_find_form;
+  const char *what = lemma ? "lemma" : "form";
+
+  char buf[MAX_RESULT_LEN];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+  if (s_search.total > s_search.count)
+    snprintf(buf, sizeof(buf), "%s %s: first %d of %d lines", what, word,
+             s_search.count, s_search.total);
+  else
+    snprintf(buf, sizeof(buf), "%s %s: %d lines", what, word, s_search.total);
+#pragma GCC diagnostic pop
+  tr_draw_text(g_font, 4, 1, buf, p->hl);
+  tr_draw_hline(0, header_h - 1, TR_SCREEN_W, p->num);
+
+  if (s_search.cursor < s_search.scroll)
+    s_search.scroll = s_search.cursor;
+  if (s_search.cursor >= s_search.scroll + rows)
+    s_search.scroll = s_search.cursor - rows + 1;
+
+  int text_x = 8 + tr_text_width(g_font, "00.000");
+  int y = header_h;
+  for (int i = s_search.scroll;
+       i < s_search.count && i < s_search.scroll + rows; i++, y += line_h) {
+    const reader_pos *h = &s_search.hits[i];
+    if (i == s_search.cursor)
+      tr_fill_rect(0, y, TR_SCREEN_W, line_h, pal_btn_bg(p));
+    snprintf(buf, sizeof(buf), "%d.%d", h->book, h->line);
+    tr_draw_text(g_font, 4, y, buf, p->num);
+    tr_draw_text(g_font, text_x, y, search_row_text(i),
+                 i == s_search.cursor ? p->hl : p->text);
+  }
+
+  int footer_y = TR_SCREEN_H - g_font->glyph_h - 2;
+  tr_draw_hline(0, footer_y - 2, TR_SCREEN_W, p->num);
+  snprintf(buf, sizeof(buf), "[A] go  [B] back  [X] by %s",
+           lemma ? "form" : "lemma");
+  tr_draw_text(g_font, 4, footer_y, buf, p->hl);
+
+  tr_flip();
+}
+
+app_state_t on_lookup_X(app_state_t s) {
+  (void)s;
+  run_search(s_find_lemma[0] ? READER_SEARCH_LEMMA : READER_SEARCH_FORM);
+  draw_search_result();
+  return ST_SEARCH;
+}
+
+app_state_t on_search_X(app_state_t s) {
+  int kind = s_search.kind == READER_SEARCH_LEMMA ? READER_SEARCH_FORM
+                                                  : READER_SEARCH_LEMMA;
+  if ((kind == READER_SEARCH_LEMMA ? s_find_lemma : s_find_form)[0]) {
+    run_search(kind);
+    draw_search_result();
+  }
+  return s;
+}
+
+app_state_t on_search_B(app_state_t s) {
+  (void)s;
+  draw_lookup_result();
+  return ST_LOOKUP;
+}
+
+/* opens the book at the line, as the go-to keyboard does */
+app_state_t on_search_A(app_state_t s) {
+  if (s_search.cursor >= s_search.count)
+    return s;
+  const reader_pos *h = &s_search.hits[s_search.cursor];
+  if (g_book >= 1 && g_book <= MAX_BOOKS)
+    g_book_lines[g_book - 1] = (int16_t)g_line_num;
+  g_book = h->book;
+  g_line_num = h->line;
+  g_row_offset = 0;
+  show_text();
+  return ST_READ;
+}
+
+static app_state_t search_move(app_state_t s, int by) {
+  int c = s_search.cursor + by;
+  if (c > s_search.count - 1)
+    c = s_search.count - 1;
+  if (c < 0)
+    c = 0;
+  if (c != s_search.cursor) {
+    s_search.cursor = c;
+    draw_search_result();
+  }
+  return s;
+}
+
+app_state_t on_search_DOWN(app_state_t s) { return search_move(s, 1); }
+app_state_t on_search_UP(app_state_t s) { return search_move(s, -1); }
+app_state_t on_search_RIGHT(app_state_t s) {
+  return search_move(s, search_rows());
+}
+app_state_t on_search_LEFT(app_state_t s) {
+  return search_move(s, -search_rows());
+}
+
+
+/* the lexicon from a typed prefix: each keystroke bounds the run of
+ * lemmas and reads only the rows on screen */
+static struct {
+  int total;  /* lemmas with the prefix */
+  int count;  /* of them in rows, from first on */
+  int first;
+  int cursor; /* place in the run */
+  reader_lex_entry rows[MAX_BROWSE_ROWS];
+} s_browse;
+
+static int browse_rows(void) {
+  int rows = search_rows();
+  return rows < MAX_BROWSE_ROWS ? rows : MAX_BROWSE_ROWS;
+}
+
+static void browse_fetch(void) {
+  prof_begin(PROF_LOOKUP);
+  reader_frame(g_ctx, READER_FRAME_LOOKUP);
+  int rows = browse_rows();
+  if (s_browse.cursor < s_browse.first)
+    s_browse.first = s_browse.cursor;
+  if (s_browse.cursor >= s_browse.first + rows)
+    s_browse.first = s_browse.cursor - rows + 1;
+  s_browse.count = reader_lex_prefix(g_ctx, g_kb.buf, s_browse.first,
+                                     s_browse.rows, rows, &s_browse.total);
+  prof_end(PROF_LOOKUP);
+}
+
+void browse_run(void) {
+  s_browse.cursor = 0;
+  s_browse.first = 0;
+  browse_fetch();
+  draw_browse_result();
+}
+
+void draw_browse_result(void) {
+  const palette_t *p = active_palette();
+  tr_select(TR_SCREEN_TOP);
+  tr_clear(p->bg);
+
+  int line_h = g_font->glyph_h + 1;
+  int header_h = line_h + 2;
+
+  char buf[MAX_RESULT_LEN];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+  if (!g_kb.buf[0])
+    snprintf(buf, sizeof(buf), "type the start of a lemma");
+  else
+    snprintf(buf, sizeof(buf), "%s: %d lemma%s", g_kb.buf, s_browse.total,
+             s_browse.total == 1 ? "" : "s");
+#pragma GCC diagnostic pop
+  tr_draw_text(g_font, 4, 1, buf, p->hl);
+  tr_draw_hline(0, header_h - 1, TR_SCREEN_W, p->num);
+
+  int y = header_h;
+  for (int i = 0; i < s_browse.count; i++, y += line_h) {
+    const reader_lex_entry *e = &s_browse.rows[i];
+    int sel = s_browse.first + i == s_browse.cursor;
+    if (sel)
+      tr_fill_rect(0, y, TR_SCREEN_W, line_h, pal_btn_bg(p));
+    tr_draw_text(g_font, 4, y, e->lemma, p->hl);
+    int x = 12 + tr_text_width(g_font, e->lemma);
+    if (x < TR_SCREEN_W)
+      tr_draw_text(g_font, x, y, e->short_def, sel ? p->hl : p->text);
+  }
+
+  int footer_y = TR_SCREEN_H - g_font->glyph_h - 2;
+  tr_draw_hline(0, footer_y - 2, TR_SCREEN_W, p->num);
+  tr_draw_text(g_font, 4, footer_y, "[A] open  [B] close", p->hl);
+
+  tr_flip();
+}
+
+/* the lemma under the cursor, in the dictionary view of the lookup
+ * screen */
+app_state_t browse_open(void) {
+  int i = s_browse.cursor - s_browse.first;
+  if (i < 0 || i >= s_browse.count)
+    return ST_KB_DICT;
+  char lemma[MAX_WORD_LEN];
+  snprintf(lemma, sizeof(lemma), "%s", s_browse.rows[i].lemma);
+  build_lookup_result(lemma, 1);
+  draw_lookup_result();
+  return ST_LOOKUP;
+}
+
+static app_state_t browse_move(app_state_t s, int by) {
+  int c = s_browse.cursor + by;
+  if (c > s_browse.total - 1)
+    c = s_browse.total - 1;
+  if (c < 0)
+    c = 0;
+  if (c != s_browse.cursor) {
+    s_browse.cursor = c;
+    browse_fetch();
+    draw_browse_result();
+  }
+  return s;
+}
+
+app_state_t on_browse_DOWN(app_state_t s) { return browse_move(s, 1); }
+app_state_t on_browse_UP(app_state_t s) { return browse_move(s, -1); }
+app_state_t on_browse_RIGHT(app_state_t s) {
+  return browse_move(s, browse_rows());
+}
+app_state_t on_browse_LEFT(app_state_t s) {
+  return browse_move(s, -browse_rows());
+}
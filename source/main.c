@@ -13,6 +13,7 @@
 char g_log_lines[LOG_MAX_LINES][LOG_LINE_LEN];
 int  g_log_count;
 
+
 void log_msg(const char *fmt, ...) {
   va_list ap;
   va_start(ap, fmt);
@@ -34,17 +35,17 @@ void log_msg(const char *fmt, ...) {
 #define CORPUS_LABEL "Homer, Iliad"
 #endif
 
-static void vblank_handler(void) {}
+static void vblank_handler(void) { tr_vblank(); }
 
 const int g_zoom_sizes[NUM_ZOOM_LEVELS] = {8, 10, 12, 14, 16};
 const char *g_font_family_names[NUM_FONT_FAMILIES] = {"Gentium", "DejaVu",
                                                       "Cardo"};
 
 tr_font *g_all_fonts[NUM_FONT_FAMILIES][NUM_ZOOM_LEVELS];
-tr_font *g_fonts[NUM_ZOOM_LEVELS];
 tr_font *g_font;
 int g_zoom_level = 1;
 int g_font_family = 0;
+int g_font_next = -1;
 
 reader_ctx *g_ctx;
 int g_num_books;
@@ -84,7 +85,13 @@ static int bot_line_count;
 static int bot_header_h;
 static int bot_line_y[MAX_PAGE_LINES];
 static int bot_line_rows[MAX_PAGE_LINES];
-static int bot_text_x[MAX_PAGE_LINES];
+/* bottom screen rows that hold rendered text; the rest is background */
+static int bot_valid_y0, bot_valid_y1;
+
+/* smooth scroll: 1 down, -1 up, 0 idle */
+static int s_glide;
+static int s_glide_moved;
+static int s_scroll_origin;
 
 
 int lines_per_screen(void) {
@@ -105,16 +112,192 @@ void recompute_page_lines(void) {
 }
 
 
-static int count_line_rows(int book, int line) {
-  static reader_line tmp[1];
-  if (reader_get_lines(g_ctx, CORPUS_WORK, book, line, 1, tmp) < 1)
-    return 1;
+static uint32_t line_key(int book, int line) {
+  return ((uint32_t)book << 16) | (uint16_t)line;
+}
+
+int line_text_x(int line) {
   char num[8];
   snprintf(num, sizeof(num), "%3d ", line);
-  int num_w = tr_text_width(g_font, num);
-  int text_x = 2 + num_w;
-  return tr_count_wrapped_lines(g_font, text_x, text_x, TR_SCREEN_W - 2,
-                                tmp[0].text);
+  return 2 + tr_text_width(g_font, num);
+}
+
+static const tr_layout *line_layout(const reader_line *ln) {
+  int text_x = line_text_x(ln->line);
+  return tr_layout_text(g_font, line_key(ln->book, ln->line), text_x, text_x,
+                        TR_SCREEN_W - 2, ln->text);
+}
+
+/* line number plus the cached wrapped text; returns rows used */
+static int draw_line(const reader_line *ln, int y) {
+  char num[8];
+  snprintf(num, sizeof(num), "%3d ", ln->line);
+  tr_draw_text(g_font, 2, y, num, active_palette()->num);
+  return tr_draw_layout(line_layout(ln), y, active_palette()->text);
+}
+
+static int layout_rows(const reader_line *ln) {
+  const tr_layout *lo = line_layout(ln);
+  return lo && lo->rows > 0 ? lo->rows : 1;
+}
+
+/* the lines around the reading position, fetched once and kept with their
+ * wrapped row counts: a top screen's worth above it, a page and
+ * LINE_FETCH_EXTRA below.  the page, the context above it and the glide all
+ * draw from here, and moving the position by a line shifts the window by
+ * one fetch and one layout at its edge.  its views are the page frame's:
+ * once a window's worth of lines has come in the frame is started over, so
+ * the blocks of lines long gone are let go */
+enum {
+  WIN_CAP = (MAX_PAGE_LINES + 2) + (MAX_PAGE_LINES + LINE_FETCH_EXTRA),
+};
+
+static struct {
+  int book; /* 0 = empty */
+  const tr_font *font;
+  int lo, hi; /* the line numbers covered */
+  int count;
+  int fetched; /* lines brought in since the frame was started */
+  reader_line lines[WIN_CAP];
+  int rows[WIN_CAP];
+} s_win;
+
+/* first window line at or after `line` */
+static int win_index(int line) {
+  int lo = 0, hi = s_win.count;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (s_win.lines[mid].line < line)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/* whether the window holds every line numbered `line` can have */
+static int win_covers(int line) {
+  return s_win.book == g_book && s_win.font == g_font && line >= s_win.lo &&
+         line <= s_win.hi;
+}
+
+static const reader_line *win_find(int book, int line) {
+  if (s_win.book != book || s_win.font != g_font)
+    return nil;
+  int i = win_index(line);
+  return i < s_win.count && s_win.lines[i].line == line ? &s_win.lines[i]
+                                                        : nil;
+}
+
+/* fetches up to `max` lines from `from` on, keeping those up to `hi`, into
+ * the window at index `at` */
+static int win_load(int book, int from, int hi, int max, int at) {
+  reader_line *dst = &s_win.lines[at];
+  int got = reader_get_lines(g_ctx, CORPUS_WORK, book, from, max, dst);
+  while (got > 0 && dst[got - 1].line > hi)
+    got--;
+  for (int i = 0; i < got; i++)
+    s_win.rows[at + i] = layout_rows(&dst[i]);
+  s_win.fetched += got;
+  return got;
+}
+
+static void bot_resync(void);
+
+/* centers the window on book:line */
+static void win_seek(int book, int line) {
+  int before = g_page_lines + 2;
+  int after = g_page_lines + LINE_FETCH_EXTRA;
+  int lo = line - before > 1 ? line - before : 1;
+  int hi = line + after - 1;
+  int maxl = reader_max_line(g_ctx, CORPUS_WORK, book);
+
+  if (book == s_win.book && g_font == s_win.font && lo == s_win.lo &&
+      hi <= s_win.hi &&
+      (s_win.count - win_index(line) >= after || s_win.hi >= maxl))
+    return;
+
+  if (book != s_win.book || lo > s_win.hi || hi < s_win.lo ||
+      s_win.fetched >= WIN_CAP) {
+    reader_frame(g_ctx, READER_FRAME_PAGE);
+    s_win.book = book;
+    s_win.font = g_font;
+    s_win.fetched = 0;
+    s_win.count = win_load(book, lo, hi, hi - lo + 1, 0);
+    bot_resync();
+  } else {
+    if (g_font != s_win.font) {
+      s_win.font = g_font;
+      for (int i = 0; i < s_win.count; i++)
+        s_win.rows[i] = layout_rows(&s_win.lines[i]);
+    }
+
+    /* drop what fell out of the span, then fetch what came into it */
+    int a = win_index(lo);
+    int n = win_index(hi + 1) - a;
+    memmove(&s_win.lines[0], &s_win.lines[a], n * sizeof(s_win.lines[0]));
+    memmove(&s_win.rows[0], &s_win.rows[a], n * sizeof(s_win.rows[0]));
+    s_win.count = n;
+    if (s_win.hi > hi)
+      s_win.hi = hi;
+
+    if (lo < s_win.lo) {
+      int gap = s_win.lo - lo;
+      memmove(&s_win.lines[gap], &s_win.lines[0], n * sizeof(s_win.lines[0]));
+      memmove(&s_win.rows[gap], &s_win.rows[0], n * sizeof(s_win.rows[0]));
+      int got = win_load(book, lo, s_win.lo - 1, gap, 0);
+      memmove(&s_win.lines[got], &s_win.lines[gap],
+              n * sizeof(s_win.lines[0]));
+      memmove(&s_win.rows[got], &s_win.rows[gap], n * sizeof(s_win.rows[0]));
+      s_win.count = got + n;
+    }
+    if (hi > s_win.hi) {
+      int from = s_win.hi + 1 > lo ? s_win.hi + 1 : lo;
+      s_win.count += win_load(book, from, hi, hi - from + 1, s_win.count);
+    }
+  }
+  s_win.lo = lo;
+  s_win.hi = hi;
+
+  /* line numbers can have gaps: reach on until a full page follows */
+  int short_by = after - (s_win.count - win_index(line));
+  if (short_by > 0 && s_win.hi < maxl) {
+    if (short_by > WIN_CAP - s_win.count)
+      short_by = WIN_CAP - s_win.count;
+    int got = win_load(book, s_win.hi + 1, maxl, short_by, s_win.count);
+    s_win.count += got;
+    s_win.hi = got ? s_win.lines[s_win.count - 1].line : maxl;
+  }
+}
+
+/* a refill started the page frame over: the glide's lines take their
+ * views from the new window */
+static void bot_resync(void) {
+  for (int i = 0; i < bot_line_count; i++) {
+    const reader_line *w = win_find(g_book, bot_lines[i].line);
+    if (w)
+      bot_lines[i] = *w;
+    else if (reader_get_lines(g_ctx, CORPUS_WORK, g_book, bot_lines[i].line,
+                              1, &bot_lines[i]) < 1)
+      bot_lines[i].text = "";
+  }
+}
+
+static int count_line_rows(int book, int line) {
+  const reader_line *w = win_find(book, line);
+  if (w)
+    return s_win.rows[w - s_win.lines];
+
+  int text_x = line_text_x(line);
+  const tr_layout *lo = tr_layout_find(g_font, line_key(book, line), text_x,
+                                       text_x, TR_SCREEN_W - 2);
+  if (!lo) {
+    reader_line tmp;
+    if (reader_get_lines(g_ctx, CORPUS_WORK, book, line, 1, &tmp) < 1)
+      return 1;
+    lo = line_layout(&tmp);
+  }
+  return lo ? lo->rows : 1;
 }
 
 static int render_lines(const reader_line *lines, int count, int first_line,
@@ -140,16 +323,7 @@ static int render_lines(const reader_line *lines, int count, int first_line,
   for (int i = 0; i < count; i++) {
     if (y + line_h > y_max)
       break;
-
-    char num[8];
-    snprintf(num, sizeof(num), "%3d ", lines[i].line);
-    int num_w = tr_text_width(g_font, num);
-    int text_x = 2 + num_w;
-
-    tr_draw_text(g_font, 2, y, num, active_palette()->num);
-    int rows = tr_draw_text_wrap(g_font, text_x, text_x, y, TR_SCREEN_W - 2,
-                                 lines[i].text, active_palette()->text);
-    y += rows * line_h;
+    y += draw_line(&lines[i], y) * line_h;
     rendered++;
   }
 
@@ -162,7 +336,7 @@ static int render_lines(const reader_line *lines, int count, int first_line,
 
 static void show_bottom_info(void) {
   const palette_t *p = active_palette();
-  const tr_font *big = g_fonts[NUM_ZOOM_LEVELS - 1];
+  const tr_font *big = ui_font(NUM_ZOOM_LEVELS - 1);
   tr_select(TR_SCREEN_BOTTOM);
   tr_clear(p->bg);
 
@@ -212,16 +386,110 @@ static void show_bottom_info(void) {
   tr_select(TR_SCREEN_TOP);
 }
 
-void show_text(void) {
+static void publish_bot_map(void) {
+  g_draw_cur_map_count = bot_line_count;
+  for (int i = 0; i < bot_line_count; i++) {
+    g_draw_cur_map[i].line = (int16_t)bot_lines[i].line;
+    g_draw_cur_map[i].y = (int16_t)bot_line_y[i];
+  }
+}
+
+/* rows one page moves by: the bottom screen when it holds the page, the
+ * top screen under its header otherwise */
+static int page_rows(void) {
+  return g_fullscreen ? TR_SCREEN_H / (g_font->glyph_h + 1) : g_page_lines;
+}
+
+/* where the page is in the book, along the right edge of the top screen
+ * below y0; left out until the book's rows are counted */
+static void draw_scrollbar(int y0) {
+  int total = rows_total(g_book);
+  int at = rows_at(g_book, g_line_num);
+  if (total <= 0 || at < 0)
+    return;
+  int track = TR_SCREEN_H - y0;
+  int y = y0 + (int)((int64_t)(at + g_row_offset) * track / total);
+  int h = (int)((int64_t)page_rows() * track / total);
+  if (h < SCROLLBAR_MIN_H)
+    h = SCROLLBAR_MIN_H;
+  if (h > track)
+    h = track;
+  if (y + h > TR_SCREEN_H)
+    y = TR_SCREEN_H - h;
+  tr_fill_rect(TR_SCREEN_W - SCROLLBAR_W, y, SCROLLBAR_W, h,
+               active_palette()->num);
+}
+
+/* fullscreen: earlier lines on the top screen, ending where the bottom
+ * screen begins */
+static void render_context(void) {
+  tr_select(TR_SCREEN_TOP);
+  tr_clear(active_palette()->bg);
+
+  if (g_line_num > 1 || g_row_offset > 0) {
+    /* the window lines before the current one, plus the current one's
+     * rows already scrolled past when we're mid-line */
+    int cur = win_index(g_line_num);
+    int cn = cur;
+    if (g_row_offset > 0 && cur < s_win.count &&
+        s_win.lines[cur].line == g_line_num)
+      cn++;
+    const reader_line *ctx_lines = s_win.lines;
+
+    int ctx_line_h = g_font->glyph_h + 1;
+    int row_counts[WIN_CAP];
+    memcpy(row_counts, s_win.rows, cn * sizeof(row_counts[0]));
+    if (cn > cur)
+      row_counts[cur] = g_row_offset;
+
+    int first = cn;
+    int rows_fit = 0;
+    for (int i = cn - 1; i >= 0; i--) {
+      if (rows_fit + row_counts[i] > TR_SCREEN_H / ctx_line_h)
+        break;
+      rows_fit += row_counts[i];
+      first = i;
+    }
+
+    int ctx_y_start = TR_SCREEN_H - rows_fit * ctx_line_h;
+    int ctx_y = ctx_y_start;
+    for (int i = first; i < cn; i++) {
+      draw_line(&ctx_lines[i], ctx_y);
+      ctx_y += row_counts[i] * ctx_line_h;
+    }
+
+    draw_line_map_t top_map[WIN_CAP];
+    int top_map_count = 0;
+    {
+      int ty = ctx_y_start;
+      for (int i = first; i < cn; i++) {
+        top_map[top_map_count].line = (int16_t)ctx_lines[i].line;
+        top_map[top_map_count].y = (int16_t)ty;
+        top_map_count++;
+        ty += row_counts[i] * ctx_line_h;
+      }
+    }
+
+    draw_render_overlay(g_book, g_zoom_level, top_map, top_map_count,
+                        active_palette()->hl);
+  }
+  draw_scrollbar(0);
+}
+
+static void render_page(void) {
   int maxl = reader_max_line(g_ctx, CORPUS_WORK, g_book);
 
-  static reader_line lines[MAX_PAGE_LINES];
+  win_seek(g_book, g_line_num);
+  int cur = win_index(g_line_num);
+  const reader_line *lines = &s_win.lines[cur];
   int fetch = g_page_lines + LINE_FETCH_EXTRA;
   if (fetch > MAX_PAGE_LINES)
     fetch = MAX_PAGE_LINES;
-  int n = reader_get_lines(g_ctx, CORPUS_WORK, g_book, g_line_num, fetch, lines);
-  if (n > MAX_PAGE_LINES)
-    n = MAX_PAGE_LINES;
+  int n = s_win.count - cur;
+  if (n > fetch)
+    n = fetch;
+
+  s_glide = 0;
 
   if (g_fullscreen) {
     tr_select(TR_SCREEN_BOTTOM);
@@ -234,112 +502,28 @@ void show_text(void) {
     for (int i = 0; i < n; i++) {
       if (y + line_h > TR_SCREEN_H)
         break;
-      char num[8];
-      snprintf(num, sizeof(num), "%3d ", lines[i].line);
-      int num_w = tr_text_width(g_font, num);
-      int text_x = 2 + num_w;
-
       bot_lines[bot_rendered] = lines[i];
       bot_line_y[bot_rendered] = y;
-      bot_text_x[bot_rendered] = text_x;
 
-      tr_draw_text(g_font, 2, y, num, active_palette()->num);
-      int rows = tr_draw_text_wrap(g_font, text_x, text_x, y, TR_SCREEN_W - 2,
-                                   lines[i].text, active_palette()->text);
+      int rows = draw_line(&lines[i], y);
       bot_line_rows[bot_rendered] = rows;
       y += rows * line_h;
       bot_rendered++;
     }
     bot_line_count = bot_rendered;
+    bot_valid_y0 = 0;
+    bot_valid_y1 = y < TR_SCREEN_H ? y : TR_SCREEN_H;
 
-    draw_line_map_t bot_map[MAX_PAGE_LINES];
-    for (int i = 0; i < bot_rendered; i++) {
-      bot_map[i].line = (int16_t)bot_lines[i].line;
-      bot_map[i].y = (int16_t)bot_line_y[i];
-    }
-
-    g_draw_cur_map_count = bot_rendered;
-    for (int i = 0; i < bot_rendered; i++)
-      g_draw_cur_map[i] = bot_map[i];
-
-    draw_render_overlay(g_book, g_zoom_level, bot_map, bot_rendered,
-                        active_palette()->hl);
-
-    tr_select(TR_SCREEN_TOP);
-    tr_clear(active_palette()->bg);
-
-    if (g_line_num > 1 || g_row_offset > 0) {
-      int per = lines_per_screen();
-      int ctx_start = g_line_num - per * 2;
-      if (ctx_start < 1)
-        ctx_start = 1;
-      /* include current line when we're mid-section so top matches bottom */
-      int ctx_count = g_line_num - ctx_start + (g_row_offset > 0 ? 1 : 0);
-
-      static reader_line ctx_lines[MAX_PAGE_LINES];
-      int cn = reader_get_lines(g_ctx, CORPUS_WORK, g_book, ctx_start, ctx_count,
-                                ctx_lines);
-
-      int ctx_line_h = g_font->glyph_h + 1;
-      int row_counts[MAX_PAGE_LINES];
-      for (int i = 0; i < cn; i++) {
-        char num[8];
-        snprintf(num, sizeof(num), "%3d ", ctx_lines[i].line);
-        int num_w = tr_text_width(g_font, num);
-        int text_x = 2 + num_w;
-        row_counts[i] = tr_count_wrapped_lines(
-            g_font, text_x, text_x, TR_SCREEN_W - 2, ctx_lines[i].text);
-        if (row_counts[i] < 1)
-          row_counts[i] = 1;
-      }
-      /* clamp current line to only the rows already scrolled past */
-      if (g_row_offset > 0 && cn > 0 &&
-          ctx_lines[cn - 1].line == g_line_num) {
-        row_counts[cn - 1] = g_row_offset;
-      }
-
-      int first = cn;
-      int rows_fit = 0;
-      for (int i = cn - 1; i >= 0; i--) {
-        if (rows_fit + row_counts[i] > TR_SCREEN_H / ctx_line_h)
-          break;
-        rows_fit += row_counts[i];
-        first = i;
-      }
-
-      int ctx_y_start = TR_SCREEN_H - rows_fit * ctx_line_h;
-      int ctx_y = ctx_y_start;
-      for (int i = first; i < cn; i++) {
-        char num[8];
-        snprintf(num, sizeof(num), "%3d ", ctx_lines[i].line);
-        int num_w = tr_text_width(g_font, num);
-        int text_x = 2 + num_w;
-
-        tr_draw_text(g_font, 2, ctx_y, num, active_palette()->num);
-        tr_draw_text_wrap(g_font, text_x, text_x, ctx_y, TR_SCREEN_W - 2,
-                          ctx_lines[i].text, active_palette()->text);
-        ctx_y += row_counts[i] * ctx_line_h;
-      }
-
-      draw_line_map_t top_map[MAX_PAGE_LINES];
-      int top_map_count = 0;
-      {
-        int ty = ctx_y_start;
-        for (int i = first; i < cn; i++) {
-          top_map[top_map_count].line = (int16_t)ctx_lines[i].line;
-          top_map[top_map_count].y = (int16_t)ty;
-          top_map_count++;
-          ty += row_counts[i] * ctx_line_h;
-        }
-      }
+    publish_bot_map();
+    draw_render_overlay(g_book, g_zoom_level, g_draw_cur_map,
+                        g_draw_cur_map_count, active_palette()->hl);
 
-      draw_render_overlay(g_book, g_zoom_level, top_map, top_map_count,
-                          active_palette()->hl);
-    }
+    render_context();
   } else {
     tr_select(TR_SCREEN_TOP);
     tr_clear(active_palette()->bg);
     int top_rendered = render_lines(lines, n, g_line_num, maxl, 1);
+    draw_scrollbar(g_font->glyph_h + 3);
 
     bot_line_count = top_rendered;
     bot_header_h = g_font->glyph_h + 3;
@@ -348,10 +532,468 @@ void show_text(void) {
 
     show_bottom_info();
   }
+}
 
+static void flip_top(void) {
+  if (g_prof_overlay)
+    draw_prof_overlay();
   tr_flip();
 }
-int touch_to_word(int tx, int ty, char *out_word, int out_len) {
+
+void show_text(void) {
+  prof_begin(PROF_SHOW_TEXT);
+  render_page();
+  prof_end(PROF_SHOW_TEXT);
+  flip_top();
+}
+
+
+/* clears bottom-screen rows [y0, y1) and redraws the text and strokes that
+ * fall inside them; rows past the screen edges are the ring's hidden part */
+static void render_band(int y0, int y1) {
+  if (y0 >= y1)
+    return;
+  int line_h = g_font->glyph_h + 1;
+  tr_select(TR_SCREEN_BOTTOM);
+  tr_set_clip(y0, y1);
+  tr_fill_rect(0, y0, TR_SCREEN_W, y1 - y0, active_palette()->bg);
+  for (int i = 0; i < bot_line_count; i++) {
+    int top = bot_line_y[i];
+    if (top < y1 && top + bot_line_rows[i] * line_h > y0)
+      draw_line(&bot_lines[i], top);
+  }
+  draw_render_overlay(g_book, g_zoom_level, g_draw_cur_map,
+                      g_draw_cur_map_count, active_palette()->hl);
+  tr_set_clip(0, TR_SCREEN_H);
+  tr_select(TR_SCREEN_TOP);
+}
+
+static int bot_push_back(void) {
+  if (bot_line_count == 0 || bot_line_count >= MAX_PAGE_LINES)
+    return 0;
+  int i = bot_line_count;
+  int next = bot_lines[i - 1].line + 1;
+  int w = win_index(next);
+  if (win_covers(next) && w < s_win.count) {
+    bot_lines[i] = s_win.lines[w];
+    bot_line_rows[i] = s_win.rows[w];
+  } else {
+    if (reader_get_lines(g_ctx, CORPUS_WORK, g_book, next, 1,
+                         &bot_lines[i]) < 1)
+      return 0;
+    bot_line_rows[i] = layout_rows(&bot_lines[i]);
+  }
+  bot_line_y[i] = bot_line_y[i - 1] + bot_line_rows[i - 1] *
+                                           (g_font->glyph_h + 1);
+  bot_line_count++;
+  return 1;
+}
+
+static int bot_push_front(void) {
+  if (bot_line_count == 0 || bot_line_count >= MAX_PAGE_LINES)
+    return 0;
+  reader_line prev;
+  int first = bot_lines[0].line;
+  int w = win_index(first);
+  if (win_covers(first - 1) && w > 0) {
+    prev = s_win.lines[w - 1];
+  } else {
+    /* line numbers can have gaps: walk back to the nearest existing one */
+    int l = first - 1;
+    for (; l >= 1; l--) {
+      if (reader_get_lines(g_ctx, CORPUS_WORK, g_book, l, 1, &prev) == 1 &&
+          prev.line < first)
+        break;
+    }
+    if (l < 1)
+      return 0;
+  }
+
+  int n = bot_line_count;
+  memmove(&bot_lines[1], &bot_lines[0], n * sizeof(bot_lines[0]));
+  memmove(&bot_line_y[1], &bot_line_y[0], n * sizeof(bot_line_y[0]));
+  memmove(&bot_line_rows[1], &bot_line_rows[0], n * sizeof(bot_line_rows[0]));
+  bot_lines[0] = prev;
+  bot_line_rows[0] = layout_rows(&prev);
+  bot_line_y[0] = bot_line_y[1] - bot_line_rows[0] * (g_font->glyph_h + 1);
+  bot_line_count++;
+  return 1;
+}
+
+/* moves the page dy pixels (positive scrolls down): the rows about to come
+ * into view are rendered into the ring's hidden part first, then the
+ * window moves over them.  returns how far it actually moved. */
+static int glide_step(int dy) {
+  int line_h = g_font->glyph_h + 1;
+  int maxl = reader_max_line(g_ctx, CORPUS_WORK, g_book);
+  int n;
+
+  if (dy > 0) {
+    while (bot_line_y[bot_line_count - 1] +
+                   bot_line_rows[bot_line_count - 1] * line_h <
+               TR_SCREEN_H + dy &&
+           bot_push_back())
+      ;
+    /* the top row of the book's last row is as far as it goes */
+    n = bot_line_count - 1;
+    if (bot_lines[n].line == maxl) {
+      int limit = bot_line_y[n] + (bot_line_rows[n] - 1) * line_h;
+      if (dy > limit)
+        dy = limit;
+    }
+    if (dy <= 0)
+      return 0;
+    publish_bot_map();
+    render_band(bot_valid_y1, TR_SCREEN_H + dy);
+  } else {
+    while (bot_line_y[0] > dy && bot_push_front())
+      ;
+    if (dy < bot_line_y[0])
+      dy = bot_line_y[0];
+    if (dy >= 0)
+      return 0;
+    publish_bot_map();
+    render_band(dy, bot_valid_y0);
+  }
+
+  s_scroll_origin += dy;
+  tr_scroll_bottom(s_scroll_origin);
+  for (int i = 0; i < bot_line_count; i++)
+    bot_line_y[i] -= dy;
+  bot_valid_y0 = 0;
+  bot_valid_y1 = TR_SCREEN_H;
+
+  /* keep just the lines that still touch the screen */
+  int drop = 0;
+  while (drop < bot_line_count - 1 &&
+         bot_line_y[drop] + bot_line_rows[drop] * line_h <= 0)
+    drop++;
+  if (drop) {
+    n = bot_line_count - drop;
+    memmove(&bot_lines[0], &bot_lines[drop], n * sizeof(bot_lines[0]));
+    memmove(&bot_line_y[0], &bot_line_y[drop], n * sizeof(bot_line_y[0]));
+    memmove(&bot_line_rows[0], &bot_line_rows[drop],
+            n * sizeof(bot_line_rows[0]));
+    bot_line_count = n;
+  }
+  while (bot_line_count > 1 &&
+         bot_line_y[bot_line_count - 1] >= TR_SCREEN_H)
+    bot_line_count--;
+
+  g_line_num = bot_lines[0].line;
+  g_row_offset = -bot_line_y[0] / line_h;
+  win_seek(g_book, g_line_num);
+  publish_bot_map();
+  return dy;
+}
+
+static void glide_start(int dir) {
+  if (s_glide != dir)
+    s_glide_moved = 0;
+  s_glide = dir;
+}
+
+/* runs every frame while gliding: keeps going while the key is held, then
+ * settles on the next row boundary, at least one row from where it began */
+static void glide_update(u32 held) {
+  if (!s_glide || bot_line_count == 0)
+    return;
+  int line_h = g_font->glyph_h + 1;
+  int into = -bot_line_y[0] % line_h;
+  int dy = SCROLL_STEP_PX;
+
+  if (!(held & (s_glide > 0 ? KEY_DOWN : KEY_UP))) {
+    int rest;
+    if (into)
+      rest = s_glide > 0 ? line_h - into : into;
+    else
+      rest = s_glide_moved ? 0 : line_h;
+    if (dy > rest)
+      dy = rest;
+  }
+
+  int moved = dy ? glide_step(s_glide * dy) : 0;
+  s_glide_moved += moved < 0 ? -moved : moved;
+  if (!moved) {
+    s_glide = 0;
+    render_context();
+    flip_top();
+  }
+}
+
+/* where L/R lands: by rows once the book is counted, so wrapped lines are
+ * neither skipped nor shown twice; by lines until then */
+static void page_target(int dir, int *line, int *row_offset) {
+  int at = rows_at(g_book, g_line_num);
+  int row = at + g_row_offset + dir * page_rows();
+  int total = rows_total(g_book);
+  if (row < 0)
+    row = 0;
+  if (total > 0 && row > total - 1)
+    row = total - 1;
+  int l, off;
+  if (at >= 0 && rows_locate(g_book, row, &l, &off)) {
+    *line = l;
+    *row_offset = off;
+    return;
+  }
+  int maxl = reader_max_line(g_ctx, CORPUS_WORK, g_book);
+  l = g_line_num + dir * g_page_lines;
+  *line = l < 1 ? 1 : l > maxl ? maxl : l;
+  *row_offset = 0;
+}
+
+/* a book's reading position, as RIGHT/LEFT reopen it */
+static int book_resume_line(int book) {
+  return book <= MAX_BOOKS && g_book_lines[book - 1] > 0
+             ? g_book_lines[book - 1]
+             : 1;
+}
+
+/* idle frames warm what the next key press would wait for: the pages L/R
+ * turn to, the pages RIGHT/LEFT open the books next door on, then the
+ * book's row table.  warming a line lays it out; the L/R pages' blocks
+ * also stay decoded, pinned in the warm frame until the position moves,
+ * so a turn is left with only the drawing.  the books next door only
+ * get their layout: their blocks are not held */
+enum {
+  IDLE_BUDGET_US = 4000,
+  IDLE_STEP_LINES = 8,
+  IDLE_SPANS = 4,
+};
+
+typedef struct {
+  int book;
+  int first, last; /* line numbers */
+} idle_span;
+
+static struct {
+  /* the position the plan was made for */
+  int book, line, row_offset, fullscreen, counted;
+  const tr_font *font;
+  idle_span spans[IDLE_SPANS];
+  int count;
+  int cur;  /* span being warmed */
+  int next; /* its next line number */
+} s_idle;
+
+static void idle_plan(void) {
+  reader_frame(g_ctx, READER_FRAME_WARM);
+  s_idle.book = g_book;
+  s_idle.line = g_line_num;
+  s_idle.row_offset = g_row_offset;
+  s_idle.fullscreen = g_fullscreen;
+  s_idle.font = g_font;
+  s_idle.counted = rows_total(g_book) >= 0;
+  s_idle.count = 0;
+  s_idle.cur = 0;
+
+  /* the window span win_seek() will want there; for the books next door
+   * just their first page, their context is only drawn on arrival */
+  int before = g_page_lines + 2;
+  int after = g_page_lines + LINE_FETCH_EXTRA;
+  for (int dir = 1; dir >= -1; dir -= 2) {
+    int line, off;
+    page_target(dir, &line, &off);
+    idle_span *sp = &s_idle.spans[s_idle.count++];
+    sp->book = g_book;
+    sp->first = line - before > 1 ? line - before : 1;
+    sp->last = line + after - 1;
+  }
+  for (int dir = 1; dir >= -1; dir -= 2) {
+    int book = g_book + dir;
+    if (book < 1 || book > g_num_books)
+      continue;
+    idle_span *sp = &s_idle.spans[s_idle.count++];
+    sp->book = book;
+    sp->first = book_resume_line(book);
+    sp->last = sp->first + after - 1;
+  }
+  s_idle.next = s_idle.spans[0].first;
+}
+
+/* warms the next few lines of the plan; 0 once it is all warm */
+static int idle_warm(void) {
+  if (s_idle.book != g_book || s_idle.line != g_line_num ||
+      s_idle.row_offset != g_row_offset ||
+      s_idle.fullscreen != g_fullscreen || s_idle.font != g_font ||
+      s_idle.counted != (rows_total(g_book) >= 0))
+    idle_plan();
+  while (s_idle.cur < s_idle.count) {
+    const idle_span *sp = &s_idle.spans[s_idle.cur];
+    reader_line lines[IDLE_STEP_LINES];
+    int n = 0;
+    if (s_idle.next <= sp->last && sp->book == g_book)
+      n = reader_warm_lines(g_ctx, CORPUS_WORK, sp->book, s_idle.next,
+                            IDLE_STEP_LINES, lines);
+    else if (s_idle.next <= sp->last)
+      n = reader_scan_lines(g_ctx, CORPUS_WORK, sp->book, s_idle.next,
+                            IDLE_STEP_LINES, lines);
+    int warmed = 0;
+    for (int i = 0; i < n && lines[i].line <= sp->last; i++) {
+      line_layout(&lines[i]);
+      warmed++;
+    }
+    reader_frame(g_ctx, READER_FRAME_SCAN);
+    if (warmed == IDLE_STEP_LINES) {
+      s_idle.next = lines[n - 1].line + 1;
+      return 1;
+    }
+    if (++s_idle.cur < s_idle.count)
+      s_idle.next = s_idle.spans[s_idle.cur].first;
+    if (warmed)
+      return 1;
+  }
+  return 0;
+}
+
+/* counts the book's row table; the position bar shows up once it is done */
+static int idle_rows(void) {
+  int counted = rows_total(g_book) >= 0;
+  int more = rows_idle();
+  if (!counted && rows_total(g_book) >= 0) {
+    if (g_fullscreen) {
+      render_context();
+      flip_top();
+    } else {
+      show_text();
+    }
+  }
+  return more;
+}
+
+int idle_work(void) {
+  u32 t0 = cpuGetTiming();
+  u32 budget = IDLE_BUDGET_US * (BUS_CLOCK / 1000000);
+  int more = 1;
+  while (more && cpuGetTiming() - t0 < budget)
+    more = idle_warm() || idle_rows();
+  return more;
+}
+
+static uint32_t s_font_used[NUM_FONT_FAMILIES][NUM_ZOOM_LEVELS];
+/* why an idle frame should load a font: ahead of a family switch, or
+ * because a screen was drawn without it */
+enum { FONT_AHEAD = 1, FONT_SHOWN = 2 };
+static uint8_t s_font_wanted[NUM_FONT_FAMILIES][NUM_ZOOM_LEVELS];
+static uint32_t s_font_clock;
+
+static int font_pinned(int fam, int zoom) {
+  if (g_all_fonts[fam][zoom] == g_font)
+    return 1;
+  if (fam == g_font_family)
+    return zoom == UI_ZOOM;
+  return fam == g_font_next && (zoom == UI_ZOOM || zoom == g_zoom_level);
+}
+
+/* everything still holding on to the font lets go of it first */
+static void font_drop(int fam, int zoom) {
+  tr_font *f = g_all_fonts[fam][zoom];
+  rows_forget_font(f);
+  if (s_win.font == f)
+    s_win.book = 0;
+  if (s_idle.font == f)
+    s_idle.font = nil;
+  tr_free_font(f);
+  g_all_fonts[fam][zoom] = nil;
+}
+
+/* makes room for one more font */
+static void font_evict(void) {
+  int loaded = 0, lru_fam = -1, lru_zoom = 0;
+  for (int fam = 0; fam < NUM_FONT_FAMILIES; fam++)
+    for (int z = 0; z < NUM_ZOOM_LEVELS; z++) {
+      if (!g_all_fonts[fam][z])
+        continue;
+      loaded++;
+      if (font_pinned(fam, z))
+        continue;
+      if (lru_fam < 0 || s_font_used[fam][z] < s_font_used[lru_fam][lru_zoom]) {
+        lru_fam = fam;
+        lru_zoom = z;
+      }
+    }
+  if (loaded >= FONT_CACHE_FONTS && lru_fam >= 0)
+    font_drop(lru_fam, lru_zoom);
+}
+
+static tr_font *font_load(int fam, int zoom) {
+  tr_font *f = g_all_fonts[fam][zoom];
+  if (!f) {
+    char path[48];
+    snprintf(path, sizeof(path), "nitro:/font_%d_%d.bin", fam,
+             g_zoom_sizes[zoom]);
+    font_evict();
+    f = g_all_fonts[fam][zoom] = tr_load_font(path);
+    if (!f)
+      log_msg("Font FAILED: %s", path);
+  }
+  s_font_used[fam][zoom] = ++s_font_clock;
+  return f;
+}
+
+tr_font *font_get(int fam, int zoom) {
+  tr_font *f = font_load(fam, zoom);
+  return f ? f : g_font;
+}
+
+tr_font *ui_font(int zoom) { return font_get(g_font_family, zoom); }
+
+tr_font *font_ready(int fam, int zoom) {
+  if (!g_all_fonts[fam][zoom]) {
+    s_font_wanted[fam][zoom] |= FONT_SHOWN;
+    return nil;
+  }
+  s_font_used[fam][zoom] = ++s_font_clock;
+  return g_all_fonts[fam][zoom];
+}
+
+void font_switch(int fam) { g_font_next = fam == g_font_family ? -1 : fam; }
+
+/* the switch is made once the family's reading and ui sizes are in */
+static int font_switch_done(void) {
+  int fam = g_font_next;
+  if (fam < 0 || !g_all_fonts[fam][g_zoom_level] ||
+      !g_all_fonts[fam][UI_ZOOM])
+    return 0;
+  g_font_next = -1;
+  g_font_family = fam;
+  g_font = g_all_fonts[fam][g_zoom_level];
+  recompute_page_lines();
+  return 1;
+}
+
+/* one font per call: a load is a run of small reads that can take most of
+ * a frame.  the screen is drawn again only for a finished or abandoned
+ * switch or a font it shows, not for the next family loading behind it */
+int fonts_idle(void) {
+  if (g_font_next >= 0) {
+    s_font_wanted[g_font_next][g_zoom_level] |= FONT_AHEAD;
+    s_font_wanted[g_font_next][UI_ZOOM] |= FONT_AHEAD;
+  }
+  if (font_switch_done())
+    return FONTS_REDRAW;
+  for (int fam = 0; fam < NUM_FONT_FAMILIES; fam++)
+    for (int z = 0; z < NUM_ZOOM_LEVELS; z++) {
+      int why = s_font_wanted[fam][z];
+      if (!why)
+        continue;
+      s_font_wanted[fam][z] = 0;
+      if (g_all_fonts[fam][z])
+        continue;
+      int shown = fam == g_font_family || (why & FONT_SHOWN);
+      if (!font_load(fam, z) && fam == g_font_next) {
+        g_font_next = -1;
+        shown = 1;
+      }
+      if (font_switch_done() || shown)
+        return FONTS_REDRAW;
+      return FONTS_LOADED;
+    }
+  return FONTS_NONE;
+}
+
+int touch_to_word(int tx, int ty, tap_word *out) {
   if (!g_fullscreen)
     return 0;
   if (bot_line_count == 0)
@@ -369,19 +1011,65 @@ int touch_to_word(int tx, int ty, char *out_word, int out_len) {
   if (line_idx < 0)
     return 0;
 
-  int found = tr_word_at_pos(
-      g_font, bot_text_x[line_idx], bot_text_x[line_idx], bot_line_y[line_idx],
-      TR_SCREEN_W - 2, bot_lines[line_idx].text, tx, ty, out_word, out_len);
-  return found;
+  const reader_line *ln = &bot_lines[line_idx];
+  out->book = ln->book;
+  out->line = ln->line;
+  return tr_layout_word_at(line_layout(ln), ln->text, bot_line_y[line_idx], tx,
+                           ty, out->word, sizeof(out->word), &out->off);
+}
+
+
+#ifdef LEXIS_BENCH
+/* glyph lookup throughput over the whole text of book 1, logged to the
+ * Logs tab; enabled with `make BENCH=1` */
+static void bench_glyph_lookup(void) {
+  enum { BENCH_BATCH = 64 };
+  static reader_line lines[BENCH_BATCH];
+  int maxl = reader_max_line(g_ctx, CORPUS_WORK, 1);
+
+  size_t cap = 1 << 16, len = 0;
+  char *text = (char *)malloc(cap);
+  if (!text)
+    return;
+  for (int line = 1; line <= maxl;) {
+    reader_frame(g_ctx, READER_FRAME_PAGE);
+    int got = reader_get_lines(g_ctx, CORPUS_WORK, 1, line, BENCH_BATCH, lines);
+    if (got < 1)
+      break;
+    for (int i = 0; i < got; i++) {
+      size_t n = strlen(lines[i].text);
+      if (len + n + 2 > cap) {
+        char *grown = (char *)realloc(text, cap * 2);
+        if (!grown)
+          break;
+        text = grown;
+        cap *= 2;
+      }
+      memcpy(text + len, lines[i].text, n);
+      len += n;
+      text[len++] = '\n';
+    }
+    line = lines[got - 1].line + 1;
+  }
+  text[len] = '\0';
+
+  for (int z = 0; z < NUM_ZOOM_LEVELS; z++) {
+    uint32_t slow, fast;
+    int glyphs = tr_bench_lookup(ui_font(z), text, &slow, &fast);
+    log_msg("bench %dpx: %d glyphs", g_zoom_sizes[z], glyphs);
+    log_msg("  %lu -> %lu glyph/s", (unsigned long)slow, (unsigned long)fast);
+  }
+  free(text);
 }
+#endif
 
 
 static app_state_t on_read_TOUCH(app_state_t s) {
   touchPosition touch;
   touchRead(&touch);
-  char tapped_word[MAX_WORD_LEN];
-  if (touch_to_word(touch.px, touch.py, tapped_word, MAX_WORD_LEN)) {
-    build_lookup_result(tapped_word, 0);
+  tap_word tap;
+  if (touch_to_word(touch.px, touch.py, &tap)) {
+    build_tap_result(&tap);
     draw_lookup_result();
     return ST_LOOKUP;
   }
@@ -396,6 +1084,10 @@ static app_state_t on_read_SELECT(app_state_t s) {
 }
 
 static app_state_t on_read_DOWN(app_state_t s) {
+  if (g_fullscreen && tr_can_scroll()) {
+    glide_start(1);
+    return s;
+  }
   int total = count_line_rows(g_book, g_line_num);
   if (g_row_offset + 1 < total) {
     g_row_offset++;
@@ -411,6 +1103,10 @@ static app_state_t on_read_DOWN(app_state_t s) {
 }
 
 static app_state_t on_read_UP(app_state_t s) {
+  if (g_fullscreen && tr_can_scroll()) {
+    glide_start(-1);
+    return s;
+  }
   if (g_row_offset > 0) {
     g_row_offset--;
   } else if (g_line_num > 1) {
@@ -427,9 +1123,7 @@ static app_state_t on_read_RIGHT(app_state_t s) {
     if (g_book >= 1 && g_book <= MAX_BOOKS)
       g_book_lines[g_book - 1] = (int16_t)g_line_num;
     g_book++;
-    g_line_num = (g_book <= MAX_BOOKS && g_book_lines[g_book - 1] > 0)
-                     ? g_book_lines[g_book - 1]
-                     : 1;
+    g_line_num = book_resume_line(g_book);
     g_row_offset = 0;
     show_text();
   }
@@ -441,31 +1135,25 @@ static app_state_t on_read_LEFT(app_state_t s) {
     if (g_book >= 1 && g_book <= MAX_BOOKS)
       g_book_lines[g_book - 1] = (int16_t)g_line_num;
     g_book--;
-    g_line_num = (g_book >= 1 && g_book_lines[g_book - 1] > 0)
-                     ? g_book_lines[g_book - 1]
-                     : 1;
+    g_line_num = book_resume_line(g_book);
     g_row_offset = 0;
     show_text();
   }
   return s;
 }
 
-static app_state_t on_read_R(app_state_t s) {
-  int maxl = reader_max_line(g_ctx, CORPUS_WORK, g_book);
-  g_line_num += g_page_lines;
-  if (g_line_num > maxl)
-    g_line_num = maxl;
-  g_row_offset = 0;
+void turn_page(int dir) {
+  page_target(dir, &g_line_num, &g_row_offset);
   show_text();
+}
+
+static app_state_t on_read_R(app_state_t s) {
+  turn_page(1);
   return s;
 }
 
 static app_state_t on_read_L(app_state_t s) {
-  g_line_num -= g_page_lines;
-  if (g_line_num < 1)
-    g_line_num = 1;
-  g_row_offset = 0;
-  show_text();
+  turn_page(-1);
   return s;
 }
 
@@ -476,6 +1164,15 @@ static app_state_t on_read_Y(app_state_t s) {
   return ST_KB_GOTO;
 }
 
+/* the lexicon, browsed from the greek keyboard */
+static app_state_t on_read_A(app_state_t s) {
+  (void)s;
+  kb_open(KB_MODE_DICT);
+  kb_draw();
+  browse_run();
+  return ST_KB_DICT;
+}
+
 static app_state_t on_read_X(app_state_t s) {
   (void)s;
   draw_show_indicator();
@@ -501,7 +1198,14 @@ static app_state_t on_draw_clear(app_state_t s) {
 static const keybind_t lookup_keys[] = {
     {KEY_TOUCH, on_lookup_TOUCH}, {KEY_B, on_lookup_B},
     {KEY_DOWN, on_lookup_DOWN},   {KEY_UP, on_lookup_UP},
-    {KEY_Y, on_lookup_Y},
+    {KEY_Y, on_lookup_Y},         {KEY_X, on_lookup_X},
+};
+
+static const keybind_t search_keys[] = {
+    {KEY_A, on_search_A},        {KEY_B, on_search_B},
+    {KEY_X, on_search_X},        {KEY_UP, on_search_UP},
+    {KEY_DOWN, on_search_DOWN},  {KEY_LEFT, on_search_LEFT},
+    {KEY_RIGHT, on_search_RIGHT},
 };
 
 static const keybind_t read_keys[] = {
@@ -510,6 +1214,7 @@ static const keybind_t read_keys[] = {
     {KEY_RIGHT, on_read_RIGHT}, {KEY_LEFT, on_read_LEFT},
     {KEY_R, on_read_R},         {KEY_L, on_read_L},
     {KEY_Y, on_read_Y},         {KEY_X, on_read_X},
+    {KEY_A, on_read_A},
 };
 
 static const keybind_t bar_keys[] = {
@@ -543,6 +1248,13 @@ static const keybind_t kb_keys[] = {
     {KEY_A, on_kb_A},
 };
 
+static const keybind_t dict_keys[] = {
+    {KEY_TOUCH, on_kb_TOUCH},     {KEY_B, on_kb_key},
+    {KEY_A, on_kb_A},             {KEY_UP, on_browse_UP},
+    {KEY_DOWN, on_browse_DOWN},   {KEY_LEFT, on_browse_LEFT},
+    {KEY_RIGHT, on_browse_RIGHT},
+};
+
 static const keybind_t draw_keys[] = {
     {KEY_X, on_draw_exit},
     {KEY_B, on_draw_exit},
@@ -555,11 +1267,13 @@ static const struct {
 } dispatch[] = {
     [ST_READ] = {read_keys, countof(read_keys)},
     [ST_LOOKUP] = {lookup_keys, countof(lookup_keys)},
+    [ST_SEARCH] = {search_keys, countof(search_keys)},
     [ST_BAR] = {bar_keys, countof(bar_keys)},
     [ST_SETTINGS] = {settings_keys, countof(settings_keys)},
     [ST_PICKER] = {picker_keys, countof(picker_keys)},
     [ST_KB_GOTO] = {kb_keys, countof(kb_keys)},
     [ST_KB_LATIN] = {kb_keys, countof(kb_keys)},
+    [ST_KB_DICT] = {dict_keys, countof(dict_keys)},
     [ST_DRAW] = {draw_keys, countof(draw_keys)},
 };
 
@@ -617,31 +1331,32 @@ int main(void) {
     log_msg("[4] No save file");
 
   printf("[5] Loading fonts...\n");
-  for (int fam = 0; fam < NUM_FONT_FAMILIES; fam++) {
-    printf("  Family %d: %s\n", fam, g_font_family_names[fam]);
-    for (int i = 0; i < NUM_ZOOM_LEVELS; i++) {
-      char path[48];
-      snprintf(path, sizeof(path), "nitro:/font_%d_%d.bin", fam,
-               g_zoom_sizes[i]);
-      g_all_fonts[fam][i] = tr_load_font(path);
-      if (!g_all_fonts[fam][i]) {
-        printf("\x1b[31mFailed: %s\x1b[0m\n", path);
-        log_msg("[5] Font FAILED: %s", path);
-        while (1)
-          swiWaitForVBlank();
-      }
-      printf("    %dpx: %dx%d\n", g_zoom_sizes[i],
-             g_all_fonts[fam][i]->glyph_w, g_all_fonts[fam][i]->glyph_h);
+  /* the rest load on first use */
+  int boot_zooms[] = {g_zoom_level, UI_ZOOM};
+  for (size_t i = 0; i < countof(boot_zooms); i++) {
+    tr_font *f = font_load(g_font_family, boot_zooms[i]);
+    if (!f) {
+      printf("\x1b[31mFailed: %s %dpx\x1b[0m\n",
+             g_font_family_names[g_font_family], g_zoom_sizes[boot_zooms[i]]);
+      while (1)
+        swiWaitForVBlank();
     }
+    printf("  %s %dpx: %dx%d\n", g_font_family_names[g_font_family],
+           g_zoom_sizes[boot_zooms[i]], f->glyph_w, f->glyph_h);
   }
-  memcpy(g_fonts, g_all_fonts[g_font_family], sizeof(g_fonts));
-  g_font = g_fonts[g_zoom_level];
+  g_font = g_all_fonts[g_font_family][g_zoom_level];
   recompute_page_lines();
   log_msg("[5] Fonts OK  %d lines/page", g_page_lines);
 
+#ifdef LEXIS_BENCH
+  bench_glyph_lookup();
+#endif
+
   printf("[6] Setting up framebuffers...\n");
   swiWaitForVBlank();
 
+  prof_init();
+
   tr_init_fb();
 
   tr_init_fb_sub();
@@ -662,6 +1377,9 @@ int main(void) {
     scanKeys();
     u32 keys = keysDown();
 
+    if (app_state == ST_READ)
+      glide_update(keysHeld());
+
     if (g_book >= 1 && g_book <= MAX_BOOKS)
       g_book_lines[g_book - 1] = (int16_t)g_line_num;
 
@@ -673,6 +1391,21 @@ int main(void) {
     if (app_state == ST_DRAW)
       draw_update();
 
+    if ((app_state == ST_READ || app_state == ST_SETTINGS) && !keys &&
+        !keysHeld() && !s_glide) {
+      prof_begin(PROF_IDLE);
+      int fonts = fonts_idle();
+      if (fonts == FONTS_REDRAW) {
+        if (app_state == ST_SETTINGS)
+          draw_settings();
+        else
+          show_text();
+      } else if (fonts == FONTS_NONE && app_state == ST_READ) {
+        idle_work();
+      }
+      prof_end(PROF_IDLE);
+    }
+
     const keybind_t *binds = dispatch[app_state].binds;
     int n = dispatch[app_state].count;
     for (int i = 0; i < n; i++) {
@@ -681,6 +1414,9 @@ int main(void) {
         break;
       }
     }
+
+    prof_frame();
+    tr_present();
   }
 
   save_state();
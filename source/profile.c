@@ -0,0 +1,57 @@
+#include "profile.h"
+
+#include <nds.h>
+
+const char *const g_prof_names[PROF_COUNT] = {
+    "show_text", "get_lines", "lookup", "overlay", "blit", "idle",
+};
+
+int g_prof_overlay;
+
+static prof_probe s_probes[PROF_COUNT];
+
+/* timers 0 and 1 run cascaded for the whole session; probes only read
+ * them, so they can nest and a wrap is harmless to the subtraction */
+void prof_init(void) { cpuStartTiming(0); }
+
+void prof_begin(int id) { s_probes[id].start = cpuGetTiming(); }
+
+void prof_end(int id) {
+  prof_probe *p = &s_probes[id];
+  p->frame += cpuGetTiming() - p->start;
+}
+
+void prof_frame(void) {
+  for (int i = 0; i < PROF_COUNT; i++) {
+    prof_probe *p = &s_probes[i];
+    if (!p->frame)
+      continue;
+    p->last = p->frame;
+    p->hist[p->head] = p->frame;
+    p->head = (p->head + 1) % PROF_WINDOW;
+    if (p->samples < PROF_WINDOW)
+      p->samples++;
+    p->frame = 0;
+  }
+}
+
+/* 0 until the probe has seen a frame */
+int prof_get(int id, prof_stats *out) {
+  const prof_probe *p = &s_probes[id];
+  if (!p->samples)
+    return 0;
+  uint64_t sum = 0;
+  out->min = UINT32_MAX;
+  out->max = 0;
+  for (int i = 0; i < p->samples; i++) {
+    uint32_t t = p->hist[i];
+    sum += t;
+    if (t < out->min)
+      out->min = t;
+    if (t > out->max)
+      out->max = t;
+  }
+  out->last = p->last;
+  out->avg = (uint32_t)(sum / p->samples);
+  return 1;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+/* named probes around the render and lookup hot paths.  a probe adds up
+ * the time of every call between two prof_frame calls, so each sample is
+ * that probe's cost for one frame. */
+
+enum {
+  PROF_SHOW_TEXT,
+  PROF_GET_LINES,
+  PROF_LOOKUP,
+  PROF_OVERLAY,
+  PROF_BLIT,
+  PROF_IDLE,
+  PROF_COUNT,
+
+  PROF_WINDOW = 16, /* samples behind the rolling min/avg/max */
+};
+
+typedef struct {
+  uint32_t start;
+  uint32_t frame; /* ticks gathered since the last prof_frame */
+  uint32_t last;
+  uint32_t hist[PROF_WINDOW];
+  int head;
+  int samples;
+} prof_probe;
+
+typedef struct {
+  uint32_t last;
+  uint32_t min;
+  uint32_t avg;
+  uint32_t max;
+} prof_stats;
+
+extern const char *const g_prof_names[PROF_COUNT];
+extern int g_prof_overlay;
+
+void prof_init(void);
+void prof_begin(int id);
+void prof_end(int id);
+void prof_frame(void);
+int prof_get(int id, prof_stats *out);
@@ -1,11 +1,29 @@
 #include "reader.h"
+#include "profile.h"
 
+#include <limits.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-enum { PRDB_MAX_BOOKS = 30 };
+enum {
+  PRDB_VERSION = 15,
+  PRDB_KEY_LEN = 8,
+  PRDB_MAX_CONC_LINES = 16,
+  PRDB_TOKEN_CHUNK = 16, /* tokens read per fread in a tap */
+};
+
+/* lookup tiers past the exact spelling, in the order they are tried */
+enum {
+  PRDB_TIER_NORM,
+  PRDB_TIER_FOLD,
+  PRDB_TIERS,
+  PRDB_NORM_KEY_MAX = 128, /* KEY_MAX in build_flatdb.py, plus the nul */
+  PRDB_MAX_HITS = 32,
+};
+
+#define PRDB_BOOK_DENSE 0xFFFFFFFFu
 
 typedef struct {
   char magic[4];
@@ -18,7 +36,41 @@ typedef struct {
   uint32_t morph_idx_off;
   uint32_t lex_idx_off;
   uint32_t strings_off;
-  uint32_t book_max[PRDB_MAX_BOOKS];
+  uint32_t pool_size;
+  uint32_t num_blocks;
+  uint32_t max_block;
+  uint32_t block_idx_off;
+  uint32_t form_hash_off;
+  uint32_t num_slots;
+  uint32_t num_buckets;
+  uint32_t hash_seed;
+  uint32_t morph_key_off;
+  uint32_t lex_key_off;
+  uint32_t morph_lex_off;
+  uint32_t num_tokens;
+  uint32_t line_tok_off; /* past the postings, read per tap */
+  uint32_t token_off;
+  uint32_t book_tab_off;
+  uint32_t num_line_map;
+  uint32_t fold_tab_off;
+  uint32_t num_fold;
+  uint32_t fold_str_size;
+  struct {
+    uint32_t off;
+    uint32_t count;
+  } morph_alias[PRDB_TIERS], lex_alias[PRDB_TIERS];
+  uint32_t search_off;
+  uint32_t num_lemma_terms;
+  uint32_t num_form_terms;
+  uint32_t postings_off; /* past the string pool, read per search */
+  uint32_t postings_size;
+  uint32_t term_key_off;
+  uint32_t conc_off;
+  uint32_t conc_lines;
+  uint32_t browse_off;
+  uint32_t num_browse;
+  uint32_t browse_key_off;
+  uint32_t browse_tier;
 } prdb_header;
 
 typedef struct {
@@ -39,23 +91,265 @@ typedef struct {
   uint32_t def_off;
 } prdb_lex;
 
+typedef struct {
+  uint32_t pool_off;
+  uint32_t data_off;
+} prdb_block;
+
+/* where a book's lines sit in the text index.  book:line is entry first +
+ * line - min_line, or first + the line's line map entry when the book's
+ * numbering has gaps */
+typedef struct {
+  uint32_t first;
+  uint32_t count;
+  uint16_t min_line;
+  uint16_t max_line;
+  uint32_t map; /* first line map entry, PRDB_BOOK_DENSE without gaps */
+} prdb_book;
+
+/* one treebank word: where it sits in its line and its reading there */
+typedef struct {
+  uint16_t start;
+  uint16_t len;
+  uint32_t morph;
+} prdb_token;
+
+/* a search term and where its posting list starts */
+typedef struct {
+  uint32_t key_off;
+  uint32_t post_off;
+} prdb_term;
+
+/* how a codepoint is spelled in the lookup keys of each tier, as offsets
+ * into the fold strings; 0 is the empty string and drops it */
+typedef struct {
+  uint32_t cp;
+  uint16_t spell[PRDB_TIERS];
+} prdb_fold;
+
+/* the first bytes of an index entry's key, zero padded, in a dense array
+ * beside the index: most binary-search probes end here, not in the pool */
+typedef struct {
+  uint8_t b[PRDB_KEY_LEN];
+} prdb_key;
+
+/* only the header and the indexes are kept in RAM.  the string pool is stored
+ * as independently LZ4-compressed blocks that never split a string; blocks
+ * are decoded on demand into a tiny LRU.  blocks under live views are
+ * pinned and never evicted; when every slot is pinned the cache grows by
+ * a slot, up to PRDB_MAX_SLOTS. */
+enum {
+  PRDB_CACHE_BLOCKS = 6,
+  PRDB_MAX_SLOTS = 16,
+};
+
+typedef struct {
+  uint32_t index; /* block number */
+  uint32_t start; /* pool offset of data[0] */
+  uint32_t len;   /* decoded length, 0 = slot unused */
+  uint32_t stamp; /* last use, for LRU eviction */
+  uint32_t pins;  /* one bit per frame holding views into the block */
+  char *data;
+} prdb_slot;
+
 struct reader_ctx {
-  uint8_t *data;
-  size_t data_size;
-  prdb_header *hdr;
+  FILE *file;
+  prdb_header hdr;
+  uint8_t *index;
+  size_t index_size;
   prdb_text *texts;
   prdb_morph *morphs;
   prdb_lex *lexicon;
-  const char *strings;
+  prdb_block *blocks;
+  const uint16_t *form_disp;
+  const uint32_t *form_slots;
+  const prdb_key *morph_keys;
+  const prdb_key *lex_keys;
+  const uint32_t *morph_lex;
+  const prdb_book *books; /* num_books + 1 entries, by book number */
+  const uint16_t *line_map;
+  const prdb_fold *fold;
+  const char *fold_str;
+  /* entries whose key differs from their spelling, by key; each array is
+   * followed by its entries' key prefixes */
+  const uint32_t *morph_alias[PRDB_TIERS];
+  const uint32_t *lex_alias[PRDB_TIERS];
+  const prdb_term *terms; /* lemmas, then forms */
+  const prdb_key *term_keys;
+  /* per lemma term: its line count, then conc_lines (text, kwic_off)
+   * pairs */
+  const uint32_t *conc;
+  const uint32_t *browse;
+  const prdb_key *browse_keys;
+  uint8_t *packed;  /* read buffer for one stored block */
+  char *decoded;    /* PRDB_CACHE_BLOCKS * max_block bytes */
+  uint32_t clock;
+  int num_slots;    /* slots past PRDB_CACHE_BLOCKS own their data */
+  int starved;      /* a block found every slot pinned, logged once */
+  prdb_slot cache[PRDB_MAX_SLOTS];
 };
 
 
-static void safe_copy(char *dst, size_t sz, const char *src) {
-  snprintf(dst, sz, "%s", src ? src : "");
+/* LZ4 raw block decoder; returns the decoded length or -1 on corrupt input */
+static int lz4_decode(const uint8_t *src, uint32_t src_len, char *dst,
+                      uint32_t dst_len) {
+  const uint8_t *ip = src;
+  const uint8_t *iend = src + src_len;
+  char *op = dst;
+  char *oend = dst + dst_len;
+
+  while (ip < iend) {
+    unsigned token = *ip++;
+
+    uint32_t len = token >> 4;
+    if (len == 15) {
+      unsigned b;
+      do {
+        if (ip >= iend)
+          return -1;
+        b = *ip++;
+        len += b;
+      } while (b == 255);
+    }
+    if (len > (uint32_t)(iend - ip) || len > (uint32_t)(oend - op))
+      return -1;
+    memcpy(op, ip, len);
+    op += len;
+    ip += len;
+    if (ip >= iend)
+      break; /* the last sequence has no match */
+
+    if (iend - ip < 2)
+      return -1;
+    uint32_t dist = (uint32_t)ip[0] | ((uint32_t)ip[1] << 8);
+    ip += 2;
+    if (dist == 0 || dist > (uint32_t)(op - dst))
+      return -1;
+
+    len = token & 15;
+    if (len == 15) {
+      unsigned b;
+      do {
+        if (ip >= iend)
+          return -1;
+        b = *ip++;
+        len += b;
+      } while (b == 255);
+    }
+    len += 4;
+    if (len > (uint32_t)(oend - op))
+      return -1;
+    const char *match = op - dist;
+    while (len--) /* matches may overlap the output */
+      *op++ = *match++;
+  }
+  return (int)(op - dst);
 }
 
-static inline const char *pool(const reader_ctx *ctx, uint32_t off) {
-  return ctx->strings + off;
+static int find_block(const reader_ctx *ctx, uint32_t off) {
+  int lo = 0, hi = (int)ctx->hdr.num_blocks - 1;
+  int found = -1;
+  while (lo <= hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (ctx->blocks[mid].pool_off <= off) {
+      found = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return found;
+}
+
+static prdb_slot *grow_cache(reader_ctx *ctx) {
+  if (ctx->num_slots >= PRDB_MAX_SLOTS)
+    return nil;
+  prdb_slot *sl = &ctx->cache[ctx->num_slots];
+  sl->data = (char *)malloc(ctx->hdr.max_block);
+  if (!sl->data)
+    return nil;
+  ctx->num_slots++;
+  return sl;
+}
+
+static prdb_slot *load_block(reader_ctx *ctx, uint32_t off) {
+  prdb_slot *victim = nil;
+  for (int i = 0; i < ctx->num_slots; i++) {
+    prdb_slot *sl = &ctx->cache[i];
+    if (sl->len && off >= sl->start && off - sl->start < sl->len) {
+      sl->stamp = ++ctx->clock;
+      return sl;
+    }
+    if (sl->pins)
+      continue;
+    if (!victim || !sl->len || (victim->len && sl->stamp < victim->stamp))
+      victim = sl;
+  }
+
+  int b = find_block(ctx, off);
+  if (b < 0)
+    return nil;
+  const prdb_block *blk = &ctx->blocks[b];
+  uint32_t raw_len = blk[1].pool_off - blk[0].pool_off;
+  uint32_t stored = blk[1].data_off - blk[0].data_off;
+  if (off - blk->pool_off >= raw_len || raw_len > ctx->hdr.max_block ||
+      stored > ctx->hdr.max_block)
+    return nil;
+  if (!victim)
+    victim = grow_cache(ctx);
+  if (!victim) {
+    /* every slot pinned: the read fails */
+    if (!ctx->starved)
+      printf("  block cache: all %d slots pinned\n", ctx->num_slots);
+    ctx->starved = 1;
+    return nil;
+  }
+
+  victim->len = 0;
+  uint8_t *dst = (stored == raw_len) ? (uint8_t *)victim->data : ctx->packed;
+  if (fseek(ctx->file, (long)(ctx->hdr.strings_off + blk->data_off),
+            SEEK_SET) != 0 ||
+      fread(dst, 1, stored, ctx->file) != stored)
+    return nil;
+  if (stored != raw_len &&
+      lz4_decode(ctx->packed, stored, victim->data, raw_len) != (int)raw_len)
+    return nil;
+  /* strings never straddle a block, so every block ends one */
+  if (victim->data[raw_len - 1] != '\0')
+    return nil;
+
+  victim->index = (uint32_t)b;
+  victim->start = blk->pool_off;
+  victim->len = raw_len;
+  victim->stamp = ++ctx->clock;
+  return victim;
+}
+
+/* a string read in passing: its block is not pinned, so the next load may
+ * evict it and callers are done with it before reading another.  a string
+ * that lives until its frame is released with reader_frame() comes from
+ * pool_view.  nil when the block cannot be read */
+static const char *pool(reader_ctx *ctx, uint32_t off) {
+  const prdb_slot *sl = load_block(ctx, off);
+  if (!sl)
+    return nil;
+  return sl->data + (off - sl->start);
+}
+
+/* a string handed out in a view: its block is pinned until the frame is
+ * released */
+static const char *pool_view(reader_ctx *ctx, uint32_t off, int frame) {
+  prdb_slot *sl = load_block(ctx, off);
+  if (!sl)
+    return "";
+  sl->pins |= 1u << frame;
+  return sl->data + (off - sl->start);
+}
+
+/* drops the views of a frame; the blocks stay cached but may be evicted */
+void reader_frame(reader_ctx *ctx, int frame) {
+  for (int i = 0; i < ctx->num_slots; i++)
+    ctx->cache[i].pins &= ~(1u << frame);
 }
 
 
@@ -147,10 +441,122 @@ void reader_format_postag(const char *postag, char *out, size_t out_size) {
 }
 
 
+/* codepoints ascending and every spelling a terminated string inside the
+ * fold strings, so the key builder needs no checks of its own */
+static int fold_ok(const reader_ctx *ctx) {
+  uint32_t size = ctx->hdr.fold_str_size;
+  if (ctx->fold_str[0] || ctx->fold_str[size - 1])
+    return 0;
+  for (uint32_t i = 0; i < ctx->hdr.num_fold; i++) {
+    const prdb_fold *f = &ctx->fold[i];
+    if (i && f->cp <= f[-1].cp)
+      return 0;
+    for (int t = 0; t < PRDB_TIERS; t++)
+      if (f->spell[t] >= size)
+        return 0;
+  }
+  return 1;
+}
+
+/* every book's range and line map inside the index, so text_find needs
+ * no checks of its own */
+static int books_ok(const reader_ctx *ctx) {
+  uint32_t next = 0;
+  for (uint32_t b = 0; b <= ctx->hdr.num_books; b++) {
+    const prdb_book *bk = &ctx->books[b];
+    uint32_t span = bk->max_line - bk->min_line + 1u;
+    if (bk->first != next || bk->count > ctx->hdr.num_texts - next)
+      return 0;
+    next += bk->count;
+    if (!bk->count)
+      continue;
+    if (bk->max_line < bk->min_line)
+      return 0;
+    if (bk->map == PRDB_BOOK_DENSE) {
+      if (bk->count != span)
+        return 0;
+      continue;
+    }
+    if (bk->map > ctx->hdr.num_line_map ||
+        span > ctx->hdr.num_line_map - bk->map)
+      return 0;
+    for (uint32_t k = 0; k < span; k++)
+      if (ctx->line_map[bk->map + k] > bk->count)
+        return 0;
+  }
+  return next == ctx->hdr.num_texts;
+}
+
+/* whether [off, off + size) lies among the indexes read at open, past
+ * the block index */
+static int in_index(const prdb_header *h, uint32_t off, uint64_t size) {
+  uint32_t start = h->block_idx_off + (h->num_blocks + 1) * 8;
+  return off >= start && off + size <= h->strings_off;
+}
+
+/* whether [off, off + size) lies in the file past the string pool, where
+ * sections are read off the card as they are needed */
+static int past_pool(const prdb_header *h, uint32_t off, uint64_t size,
+                     long sz) {
+  return off >= h->strings_off && off + size <= (uint64_t)sz;
+}
+
+/* the first section the header places outside the file, nil when every
+ * one fits */
+static const char *bad_section(const prdb_header *h, long sz) {
+  uint64_t disp_size = (h->num_buckets * 2 + 3) & ~3u;
+  if (!h->num_buckets ||
+      !in_index(h, h->form_hash_off, disp_size + (uint64_t)h->num_slots * 4))
+    return "form hash";
+  if (!in_index(h, h->morph_key_off, (uint64_t)h->num_morphs * PRDB_KEY_LEN) ||
+      !in_index(h, h->lex_key_off, (uint64_t)h->num_lex * PRDB_KEY_LEN))
+    return "key prefixes";
+  if (!in_index(h, h->morph_lex_off, (uint64_t)h->num_morphs * 4))
+    return "morph lex links";
+  if (!past_pool(h, h->line_tok_off, ((uint64_t)h->num_texts + 1) * 4, sz) ||
+      !past_pool(h, h->token_off, (uint64_t)h->num_tokens * sizeof(prdb_token),
+                 sz))
+    return "tokens";
+  if (!in_index(h, h->book_tab_off,
+                ((uint64_t)h->num_books + 1) * sizeof(prdb_book) +
+                    (uint64_t)h->num_line_map * 2))
+    return "book table";
+  if (!h->fold_str_size ||
+      !in_index(h, h->fold_tab_off,
+                (uint64_t)h->num_fold * sizeof(prdb_fold) + h->fold_str_size))
+    return "fold table";
+  for (int t = 0; t < PRDB_TIERS; t++)
+    if (!in_index(h, h->morph_alias[t].off,
+                  (uint64_t)h->morph_alias[t].count * (4 + PRDB_KEY_LEN)) ||
+        !in_index(h, h->lex_alias[t].off,
+                  (uint64_t)h->lex_alias[t].count * (4 + PRDB_KEY_LEN)))
+      return "aliases";
+  uint64_t num_terms = (uint64_t)h->num_lemma_terms + h->num_form_terms;
+  if (!in_index(h, h->search_off, num_terms * sizeof(prdb_term)) ||
+      !in_index(h, h->term_key_off, num_terms * PRDB_KEY_LEN) ||
+      !past_pool(h, h->postings_off, h->postings_size, sz))
+    return "search index";
+  if (!h->conc_lines || h->conc_lines > PRDB_MAX_CONC_LINES ||
+      !in_index(h, h->conc_off,
+                (uint64_t)h->num_lemma_terms * (1 + 2 * h->conc_lines) * 4))
+    return "concordance";
+  if (h->browse_tier >= PRDB_TIERS ||
+      !in_index(h, h->browse_off, (uint64_t)h->num_browse * 4) ||
+      !in_index(h, h->browse_key_off, (uint64_t)h->num_browse * PRDB_KEY_LEN))
+    return "browse index";
+  return nil;
+}
+
 reader_ctx *reader_open(const char *db_path) {
   _Static_assert(sizeof(prdb_text) == 8, "prdb_text packing");
   _Static_assert(sizeof(prdb_morph) == 12, "prdb_morph packing");
   _Static_assert(sizeof(prdb_lex) == 12, "prdb_lex packing");
+  _Static_assert(sizeof(prdb_block) == 8, "prdb_block packing");
+  _Static_assert(sizeof(prdb_token) == 8, "prdb_token packing");
+  _Static_assert(sizeof(prdb_book) == 16, "prdb_book packing");
+  _Static_assert(sizeof(prdb_fold) == 8, "prdb_fold packing");
+  _Static_assert(sizeof(prdb_term) == 8, "prdb_term packing");
+  _Static_assert(sizeof(prdb_header) == 196, "prdb_header packing");
 
   if (!db_path)
     db_path = "nitro:/lexis.dat";
@@ -169,53 +575,121 @@ reader_ctx *reader_open(const char *db_path) {
 
   printf("  file size: %ld bytes\n", sz);
 
-  if (sz < (long)sizeof(prdb_header)) {
+  prdb_header hdr;
+  if (sz < (long)sizeof(hdr) || fread(&hdr, sizeof(hdr), 1, f) != 1) {
     fclose(f);
     return nil;
   }
 
-  uint8_t *data = (uint8_t *)malloc((size_t)sz);
-  if (!data) {
+  if (memcmp(hdr.magic, "PRDB", 4) != 0 || hdr.version != PRDB_VERSION) {
     fclose(f);
-    printf("  malloc(%ld) failed!\n", sz);
+    printf("  bad magic/version\n");
     return nil;
   }
 
-  size_t rd = fread(data, 1, (size_t)sz, f);
-  fclose(f);
+  if (hdr.text_idx_off < sizeof(hdr) || hdr.block_idx_off < hdr.text_idx_off ||
+      hdr.strings_off < hdr.block_idx_off + (hdr.num_blocks + 1) * 8 ||
+      (long)hdr.strings_off > sz || hdr.num_blocks == 0) {
+    fclose(f);
+    printf("  bad section offsets\n");
+    return nil;
+  }
 
-  if ((long)rd != sz) {
-    free(data);
-    printf("  fread short: %zu / %ld\n", rd, sz);
+  const char *bad = bad_section(&hdr, sz);
+  if (bad) {
+    fclose(f);
+    printf("  bad %s\n", bad);
     return nil;
   }
 
-  printf("  loaded %ld bytes OK\n", sz);
+  /* text, morph, lex and block indexes are contiguous: one read for all */
+  size_t index_size = hdr.strings_off - hdr.text_idx_off;
+  uint8_t *index = (uint8_t *)malloc(index_size ? index_size : 1);
+  if (!index) {
+    fclose(f);
+    printf("  malloc(%zu) failed!\n", index_size);
+    return nil;
+  }
 
-  prdb_header *hdr = (prdb_header *)data;
-  if (memcmp(hdr->magic, "PRDB", 4) != 0 || hdr->version != 1) {
-    free(data);
-    printf("  bad magic/version\n");
+  fseek(f, (long)hdr.text_idx_off, SEEK_SET);
+  size_t rd = fread(index, 1, index_size, f);
+  if (rd != index_size) {
+    free(index);
+    fclose(f);
+    printf("  fread short: %zu / %zu\n", rd, index_size);
     return nil;
   }
 
   reader_ctx *ctx = (reader_ctx *)calloc(1, sizeof(*ctx));
   if (!ctx) {
-    free(data);
+    free(index);
+    fclose(f);
     return nil;
   }
 
-  ctx->data = data;
-  ctx->data_size = (size_t)sz;
+  ctx->file = f;
   ctx->hdr = hdr;
-  ctx->texts = (prdb_text *)(data + hdr->text_idx_off);
-  ctx->morphs = (prdb_morph *)(data + hdr->morph_idx_off);
-  ctx->lexicon = (prdb_lex *)(data + hdr->lex_idx_off);
-  ctx->strings = (const char *)(data + hdr->strings_off);
+  ctx->index = index;
+  ctx->index_size = index_size;
+  ctx->texts = (prdb_text *)index;
+  ctx->morphs = (prdb_morph *)(index + (hdr.morph_idx_off - hdr.text_idx_off));
+  ctx->lexicon = (prdb_lex *)(index + (hdr.lex_idx_off - hdr.text_idx_off));
+  ctx->blocks = (prdb_block *)(index + (hdr.block_idx_off - hdr.text_idx_off));
+  uint8_t *h = index + (hdr.form_hash_off - hdr.text_idx_off);
+  ctx->form_disp = (const uint16_t *)h;
+  ctx->form_slots = (const uint32_t *)(h + ((hdr.num_buckets * 2 + 3) & ~3u));
+  ctx->morph_keys =
+      (const prdb_key *)(index + (hdr.morph_key_off - hdr.text_idx_off));
+  ctx->lex_keys =
+      (const prdb_key *)(index + (hdr.lex_key_off - hdr.text_idx_off));
+  ctx->morph_lex =
+      (const uint32_t *)(index + (hdr.morph_lex_off - hdr.text_idx_off));
+  ctx->books =
+      (const prdb_book *)(index + (hdr.book_tab_off - hdr.text_idx_off));
+  ctx->line_map = (const uint16_t *)(ctx->books + hdr.num_books + 1);
+  ctx->fold =
+      (const prdb_fold *)(index + (hdr.fold_tab_off - hdr.text_idx_off));
+  ctx->fold_str = (const char *)(ctx->fold + hdr.num_fold);
+  for (int t = 0; t < PRDB_TIERS; t++) {
+    ctx->morph_alias[t] = (const uint32_t *)(
+        index + (hdr.morph_alias[t].off - hdr.text_idx_off));
+    ctx->lex_alias[t] = (const uint32_t *)(
+        index + (hdr.lex_alias[t].off - hdr.text_idx_off));
+  }
+  ctx->terms =
+      (const prdb_term *)(index + (hdr.search_off - hdr.text_idx_off));
+  ctx->term_keys =
+      (const prdb_key *)(index + (hdr.term_key_off - hdr.text_idx_off));
+  ctx->conc = (const uint32_t *)(index + (hdr.conc_off - hdr.text_idx_off));
+  ctx->browse =
+      (const uint32_t *)(index + (hdr.browse_off - hdr.text_idx_off));
+  ctx->browse_keys =
+      (const prdb_key *)(index + (hdr.browse_key_off - hdr.text_idx_off));
+  bad = !books_ok(ctx) ? "book table" : !fold_ok(ctx) ? "fold table" : nil;
+  if (bad) {
+    printf("  bad %s\n", bad);
+    reader_close(ctx);
+    return nil;
+  }
 
+  ctx->packed = (uint8_t *)malloc(hdr.max_block);
+  ctx->decoded = (char *)malloc((size_t)hdr.max_block * PRDB_CACHE_BLOCKS);
+  if (!ctx->packed || !ctx->decoded) {
+    printf("  block cache malloc failed!\n");
+    reader_close(ctx);
+    return nil;
+  }
+  for (int i = 0; i < PRDB_CACHE_BLOCKS; i++)
+    ctx->cache[i].data = ctx->decoded + (size_t)i * hdr.max_block;
+  ctx->num_slots = PRDB_CACHE_BLOCKS;
+
+  printf("  index %zu bytes resident\n", index_size);
+  printf("  pool %lu bytes in %lu blocks (%ld packed)\n",
+         (unsigned long)hdr.pool_size, (unsigned long)hdr.num_blocks,
+         sz - (long)hdr.strings_off);
   printf("  %lu texts, %lu morphs, %lu lex, %lu books\n",
-         (unsigned long)hdr->num_texts, (unsigned long)hdr->num_morphs,
-         (unsigned long)hdr->num_lex, (unsigned long)hdr->num_books);
+         (unsigned long)hdr.num_texts, (unsigned long)hdr.num_morphs,
+         (unsigned long)hdr.num_lex, (unsigned long)hdr.num_books);
 
   return ctx;
 }
@@ -223,32 +697,39 @@ reader_ctx *reader_open(const char *db_path) {
 void reader_close(reader_ctx *ctx) {
   if (!ctx)
     return;
-  free(ctx->data);
+  fclose(ctx->file);
+  for (int i = PRDB_CACHE_BLOCKS; i < ctx->num_slots; i++)
+    free(ctx->cache[i].data);
+  free(ctx->decoded);
+  free(ctx->packed);
+  free(ctx->index);
   free(ctx);
 }
 
 
-int reader_get_lines(reader_ctx *ctx, const char *work, int book,
-                     int start_line, int count, reader_line *out) {
-  (void)work;
-
-  uint32_t num = ctx->hdr->num_texts;
-
-  int lo = 0, hi = (int)num - 1;
-  int pos = (int)num;
+/* first text index entry at or after book:line, without a search */
+static int text_find(const reader_ctx *ctx, int book, int line) {
+  if (book < 0)
+    return 0;
+  if (book > (int)ctx->hdr.num_books)
+    return (int)ctx->hdr.num_texts;
+  const prdb_book *bk = &ctx->books[book];
+  if (!bk->count || line <= bk->min_line)
+    return (int)bk->first;
+  if (line > bk->max_line)
+    return (int)(bk->first + bk->count);
+  uint32_t k = (uint32_t)(line - bk->min_line);
+  if (bk->map != PRDB_BOOK_DENSE)
+    k = ctx->line_map[bk->map + k];
+  return (int)(bk->first + k);
+}
 
-  while (lo <= hi) {
-    int mid = lo + (hi - lo) / 2;
-    int b = ctx->texts[mid].book;
-    int l = ctx->texts[mid].line;
+static int get_lines(reader_ctx *ctx, int book, int start_line, int count,
+                     reader_line *out, int frame) {
+  prof_begin(PROF_GET_LINES);
 
-    if (b < book || (b == book && l < start_line)) {
-      lo = mid + 1;
-    } else {
-      pos = mid;
-      hi = mid - 1;
-    }
-  }
+  uint32_t num = ctx->hdr.num_texts;
+  int pos = text_find(ctx, book, start_line);
 
   int n = 0;
   for (int i = pos; i < (int)num && n < count; i++) {
@@ -256,35 +737,222 @@ int reader_get_lines(reader_ctx *ctx, const char *work, int book,
       break;
     out[n].book = ctx->texts[i].book;
     out[n].line = ctx->texts[i].line;
-    safe_copy(out[n].text, sizeof(out[n].text),
-              pool(ctx, ctx->texts[i].text_off));
+    out[n].text = pool_view(ctx, ctx->texts[i].text_off, frame);
     n++;
   }
+  prof_end(PROF_GET_LINES);
   return n;
 }
 
+int reader_get_lines(reader_ctx *ctx, const char *work, int book,
+                     int start_line, int count, reader_line *out) {
+  (void)work;
+  return get_lines(ctx, book, start_line, count, out, READER_FRAME_PAGE);
+}
+
+int reader_scan_lines(reader_ctx *ctx, const char *work, int book,
+                      int start_line, int count, reader_line *out) {
+  (void)work;
+  return get_lines(ctx, book, start_line, count, out, READER_FRAME_SCAN);
+}
+
+int reader_warm_lines(reader_ctx *ctx, const char *work, int book,
+                      int start_line, int count, reader_line *out) {
+  (void)work;
+  return get_lines(ctx, book, start_line, count, out, READER_FRAME_WARM);
+}
+
 int reader_book_count(reader_ctx *ctx, const char *work) {
   (void)work;
-  return (int)ctx->hdr->num_books;
+  return (int)ctx->hdr.num_books;
 }
 
 int reader_max_line(reader_ctx *ctx, const char *work, int book) {
   (void)work;
-  if (book >= 1 && book < PRDB_MAX_BOOKS)
-    return (int)ctx->hdr->book_max[book];
+  if (book >= 1 && book <= (int)ctx->hdr.num_books)
+    return ctx->books[book].max_line;
   return 0;
 }
 
 
-int reader_morph_lookup(reader_ctx *ctx, const char *form, reader_morph *out,
-                        int max_results) {
-  uint32_t num = ctx->hdr->num_morphs;
+static void make_key(const char *s, prdb_key *k) {
+  size_t i = 0;
+  for (; i < PRDB_KEY_LEN && s[i]; i++)
+    k->b[i] = (uint8_t)s[i];
+  for (; i < PRDB_KEY_LEN; i++)
+    k->b[i] = 0;
+}
+
+/* what the compares below return when the entry's string cannot be read;
+ * the search gives up rather than steer by it */
+enum { PRDB_UNREAD = INT_MIN };
+
+/* strcmp(s, entry i's string), settled on the key prefixes when they
+ * differ or when s ends inside them: equal prefixes then mean equal
+ * strings */
+static int key_cmp(reader_ctx *ctx, const char *s, const prdb_key *qk,
+                   const prdb_key *keys, int i, uint32_t off) {
+  int c = memcmp(qk, &keys[i], PRDB_KEY_LEN);
+  if (c || !qk->b[PRDB_KEY_LEN - 1])
+    return c;
+  const char *p = pool(ctx, off);
+  return p ? strcmp(s, p) : PRDB_UNREAD;
+}
+
+/* must match build_flatdb.py */
+#define PRDB_HASH_PHI 0x9E3779B9u
+
+static uint32_t fnv1a(const char *s, uint32_t seed) {
+  uint32_t h = 2166136261u ^ seed;
+  for (; *s; s++)
+    h = (h ^ (uint8_t)*s) * 16777619u;
+  return h;
+}
+
+static uint32_t mix32(uint32_t h) {
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return h;
+}
+
+/* x mapped onto [0, n) with a multiply; the arm9 has no divider */
+static inline uint32_t fastrange(uint32_t x, uint32_t n) {
+  return (uint32_t)(((uint64_t)x * n) >> 32);
+}
+
+/* first morph entry for a form through the form hash: a displacement, a
+ * slot and the one string compare that rules out non-forms */
+static int morph_hash_find(reader_ctx *ctx, const char *form,
+                           const prdb_key *qk) {
+  const prdb_header *h = &ctx->hdr;
+  uint32_t b = fastrange(mix32(fnv1a(form, h->hash_seed)), h->num_buckets);
+  uint32_t step = PRDB_HASH_PHI * (ctx->form_disp[b] + 1u);
+  uint32_t slot =
+      fastrange(mix32(fnv1a(form, ~h->hash_seed) + step), h->num_slots);
+  uint32_t i = ctx->form_slots[slot];
+  if (i >= h->num_morphs ||
+      key_cmp(ctx, form, qk, ctx->morph_keys, (int)i, ctx->morphs[i].form_off))
+    return -1;
+  return (int)i;
+}
+
+static void morph_view(reader_ctx *ctx, uint32_t i, reader_morph *out) {
+  const prdb_morph *m = &ctx->morphs[i];
+  out->form = pool_view(ctx, m->form_off, READER_FRAME_LOOKUP);
+  out->lemma = pool_view(ctx, m->lemma_off, READER_FRAME_LOOKUP);
+  out->postag = pool_view(ctx, m->postag_off, READER_FRAME_LOOKUP);
+  if (ctx->morph_lex[i] < ctx->hdr.num_lex)
+    out->lex_idx = (int)ctx->morph_lex[i];
+  else
+    out->lex_idx = READER_LEX_NONE;
+}
+
+/* the morph entries spelled exactly `form` */
+static int morph_exact(reader_ctx *ctx, const char *form, uint32_t *hits,
+                       int max) {
+  uint32_t num = ctx->hdr.num_morphs;
+  prdb_key qk;
+  make_key(form, &qk);
+  int first = morph_hash_find(ctx, form, &qk);
+  if (first < 0)
+    return 0;
+
+  /* every entry of the run carries the form itself */
+  int n = 0;
+  for (int i = first; i < (int)num && n < max; i++) {
+    if (key_cmp(ctx, form, &qk, ctx->morph_keys, i, ctx->morphs[i].form_off))
+      break;
+    hits[n++] = (uint32_t)i;
+  }
+  return n;
+}
+
+/* the token run of a line is short and sorted by start: it is read off
+ * the card a chunk at a time and scanned until a token overlaps the
+ * tapped bytes or starts past them */
+int reader_token_lookup(reader_ctx *ctx, int book, int line, int off, int len,
+                        reader_morph *out, int max_results) {
+  if (max_results < 1)
+    return 0;
+  int t = text_find(ctx, book, line);
+  if (t >= (int)ctx->hdr.num_texts || ctx->texts[t].book != (uint16_t)book ||
+      ctx->texts[t].line != (uint16_t)line)
+    return 0;
+
+  uint32_t run[2];
+  if (fseek(ctx->file, (long)(ctx->hdr.line_tok_off + (uint32_t)t * 4),
+            SEEK_SET) != 0 ||
+      fread(run, 4, 2, ctx->file) != 2 || run[0] > run[1] ||
+      run[1] > ctx->hdr.num_tokens ||
+      fseek(ctx->file,
+            (long)(ctx->hdr.token_off + run[0] * sizeof(prdb_token)),
+            SEEK_SET) != 0)
+    return 0;
+  prdb_token tok[PRDB_TOKEN_CHUNK];
+  uint32_t m = UINT32_MAX;
+  int end = off + (len > 0 ? len : 1);
+  for (uint32_t i = run[0]; i < run[1];) {
+    uint32_t n = run[1] - i < PRDB_TOKEN_CHUNK ? run[1] - i : PRDB_TOKEN_CHUNK;
+    if (fread(tok, sizeof(prdb_token), n, ctx->file) != n)
+      return 0;
+    i += n;
+    /* past the tokens that end before the tap, the next one either
+     * overlaps it or starts after it */
+    uint32_t k = 0;
+    while (k < n && off >= tok[k].start + tok[k].len)
+      k++;
+    if (k < n) {
+      if (tok[k].start < end)
+        m = tok[k].morph;
+      break;
+    }
+  }
+  if (m >= ctx->hdr.num_morphs)
+    return 0;
+
+  /* the reading in context, then the rest of the form's run; the pool
+   * interns strings, so the run shares one form offset */
+  uint32_t form_off = ctx->morphs[m].form_off;
+  morph_view(ctx, m, &out[0]);
+  int n = 1;
+  uint32_t first = m;
+  while (first > 0 && ctx->morphs[first - 1].form_off == form_off)
+    first--;
+  for (uint32_t i = first; i < ctx->hdr.num_morphs && n < max_results; i++) {
+    if (ctx->morphs[i].form_off != form_off)
+      break;
+    if (i != m)
+      morph_view(ctx, i, &out[n++]);
+  }
+  return n;
+}
+
+
+static void lex_view(reader_ctx *ctx, uint32_t i, reader_lex_entry *out) {
+  out->lemma = pool_view(ctx, ctx->lexicon[i].lemma_off, READER_FRAME_LOOKUP);
+  out->short_def =
+      pool_view(ctx, ctx->lexicon[i].short_def_off, READER_FRAME_LOOKUP);
+  out->idx = (int)i;
+}
+
+/* the lex entries spelled exactly `lemma` */
+static int lex_exact(reader_ctx *ctx, const char *lemma, uint32_t *hits,
+                     int max) {
+  uint32_t num = ctx->hdr.num_lex;
   int lo = 0, hi = (int)num - 1;
   int first = -1;
+  prdb_key qk;
+  make_key(lemma, &qk);
 
   while (lo <= hi) {
     int mid = lo + (hi - lo) / 2;
-    int cmp = strcmp(form, pool(ctx, ctx->morphs[mid].form_off));
+    int cmp = key_cmp(ctx, lemma, &qk, ctx->lex_keys, mid,
+                      ctx->lexicon[mid].lemma_off);
+    if (cmp == PRDB_UNREAD)
+      return 0;
     if (cmp < 0)
       hi = mid - 1;
     else if (cmp > 0)
@@ -299,32 +967,109 @@ int reader_morph_lookup(reader_ctx *ctx, const char *form, reader_morph *out,
     return 0;
 
   int n = 0;
-  for (int i = first; i < (int)num && n < max_results; i++) {
-    if (strcmp(form, pool(ctx, ctx->morphs[i].form_off)) != 0)
+  for (int i = first; i < (int)num && n < max; i++) {
+    if (key_cmp(ctx, lemma, &qk, ctx->lex_keys, i,
+                ctx->lexicon[i].lemma_off))
       break;
-    safe_copy(out[n].form, sizeof(out[n].form),
-              pool(ctx, ctx->morphs[i].form_off));
-    safe_copy(out[n].lemma, sizeof(out[n].lemma),
-              pool(ctx, ctx->morphs[i].lemma_off));
-    safe_copy(out[n].postag, sizeof(out[n].postag),
-              pool(ctx, ctx->morphs[i].postag_off));
-    reader_format_postag(out[n].postag, out[n].parse_str,
-                         sizeof(out[n].parse_str));
-    n++;
+    hits[n++] = (uint32_t)i;
   }
   return n;
 }
 
 
-static int lex_bsearch(reader_ctx *ctx, const char *lemma,
-                       reader_lex_entry *out, int max_results) {
-  uint32_t num = ctx->hdr->num_lex;
-  int lo = 0, hi = (int)num - 1;
-  int first = -1;
+/* one codepoint of s, stepping past it; a malformed byte stands for
+ * itself */
+static uint32_t utf8_next(const char **s) {
+  const uint8_t *p = (const uint8_t *)*s;
+  uint32_t c = p[0];
+  int n = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+  uint32_t cp = n ? c & (0x3Fu >> n) : c;
+  for (int i = 1; i <= n; i++) {
+    if ((p[i] & 0xC0) != 0x80) {
+      n = 0;
+      cp = c;
+      break;
+    }
+    cp = cp << 6 | (p[i] & 0x3Fu);
+  }
+  *s += n + 1;
+  return cp;
+}
+
+/* s spelled for a lookup tier: every codepoint the way the file's fold
+ * table spells it, which is how build_flatdb.py sorted the aliases.  0
+ * when the key comes out empty or too long */
+static int lookup_key(const reader_ctx *ctx, const char *s, int tier,
+                      char *out) {
+  size_t n = 0;
+  while (*s) {
+    const char *spell = s;
+    uint32_t cp = utf8_next(&s);
+    size_t len = (size_t)(s - spell);
+    int lo = 0, hi = (int)ctx->hdr.num_fold - 1;
+    while (lo <= hi) {
+      int mid = lo + (hi - lo) / 2;
+      if (ctx->fold[mid].cp < cp) {
+        lo = mid + 1;
+      } else if (ctx->fold[mid].cp > cp) {
+        hi = mid - 1;
+      } else {
+        spell = ctx->fold_str + ctx->fold[mid].spell[tier];
+        len = strlen(spell);
+        break;
+      }
+    }
+    if (n + len >= PRDB_NORM_KEY_MAX)
+      return 0;
+    memcpy(out + n, spell, len);
+    n += len;
+  }
+  out[n] = '\0';
+  return n > 0;
+}
+
+static int exact_run(reader_ctx *ctx, int lex, const char *s, uint32_t *hits,
+                     int max) {
+  return lex ? lex_exact(ctx, s, hits, max) : morph_exact(ctx, s, hits, max);
+}
 
+/* strcmp(key, entry i's key), settled on the key prefixes like key_cmp;
+ * only a tie spells the entry's key afresh */
+static int alias_cmp(reader_ctx *ctx, int lex, int tier, const char *key,
+                     const prdb_key *qk, const prdb_key *ik, uint32_t i) {
+  int c = memcmp(qk, ik, PRDB_KEY_LEN);
+  if (c || !qk->b[PRDB_KEY_LEN - 1])
+    return c;
+  char probe[PRDB_NORM_KEY_MAX];
+  uint32_t num = lex ? ctx->hdr.num_lex : ctx->hdr.num_morphs;
+  if (i >= num)
+    return -1;
+  const char *s =
+      pool(ctx, lex ? ctx->lexicon[i].lemma_off : ctx->morphs[i].form_off);
+  if (!s)
+    return PRDB_UNREAD;
+  if (!lookup_key(ctx, s, tier, probe))
+    return -1;
+  return strcmp(key, probe);
+}
+
+/* the entries whose own key in the tier is `key` */
+static int alias_run(reader_ctx *ctx, int lex, int tier, const char *key,
+                     uint32_t *hits, int max) {
+  const uint32_t *alias = lex ? ctx->lex_alias[tier] : ctx->morph_alias[tier];
+  int count = (int)(lex ? ctx->hdr.lex_alias[tier].count
+                        : ctx->hdr.morph_alias[tier].count);
+  const prdb_key *keys = (const prdb_key *)(alias + count);
+  prdb_key qk;
+  make_key(key, &qk);
+
+  int lo = 0, hi = count - 1;
+  int first = -1;
   while (lo <= hi) {
     int mid = lo + (hi - lo) / 2;
-    int cmp = strcmp(lemma, pool(ctx, ctx->lexicon[mid].lemma_off));
+    int cmp = alias_cmp(ctx, lex, tier, key, &qk, &keys[mid], alias[mid]);
+    if (cmp == PRDB_UNREAD)
+      return 0;
     if (cmp < 0)
       hi = mid - 1;
     else if (cmp > 0)
@@ -334,45 +1079,258 @@ static int lex_bsearch(reader_ctx *ctx, const char *lemma,
       hi = mid - 1;
     }
   }
-
   if (first < 0)
     return 0;
 
   int n = 0;
-  for (int i = first; i < (int)num && n < max_results; i++) {
-    if (strcmp(lemma, pool(ctx, ctx->lexicon[i].lemma_off)) != 0)
+  for (int i = first; i < count && n < max; i++) {
+    if (alias_cmp(ctx, lex, tier, key, &qk, &keys[i], alias[i]))
       break;
-    safe_copy(out[n].lemma, sizeof(out[n].lemma),
-              pool(ctx, ctx->lexicon[i].lemma_off));
-    safe_copy(out[n].short_def, sizeof(out[n].short_def),
-              pool(ctx, ctx->lexicon[i].short_def_off));
-    safe_copy(out[n].definition, sizeof(out[n].definition),
-              pool(ctx, ctx->lexicon[i].def_off));
-    n++;
+    hits[n++] = alias[i];
   }
   return n;
 }
 
+/* the spelling as given, else its normalized key, else its folded key.  a
+ * tier matches the entries spelled like the key, then the entries whose
+ * own key it is; a tapped "λόγον," or "ἀλλ'" and a numbered lemma all
+ * land in the normalized tier */
+static int tiered_find(reader_ctx *ctx, int lex, const char *s,
+                       uint32_t *hits, int max) {
+  char keys[PRDB_TIERS][PRDB_NORM_KEY_MAX];
+  if (max > PRDB_MAX_HITS)
+    max = PRDB_MAX_HITS;
+  int n = exact_run(ctx, lex, s, hits, max);
+  const char *last = s;
+  for (int t = 0; !n && t < PRDB_TIERS; t++) {
+    if (!lookup_key(ctx, s, t, keys[t]))
+      continue;
+    if (strcmp(keys[t], last))
+      n = exact_run(ctx, lex, keys[t], hits, max);
+    n += alias_run(ctx, lex, t, keys[t], hits + n, max - n);
+    last = keys[t];
+  }
+  return n;
+}
+
+int reader_morph_lookup(reader_ctx *ctx, const char *form, reader_morph *out,
+                        int max_results) {
+  uint32_t hits[PRDB_MAX_HITS];
+  int n = tiered_find(ctx, 0, form, hits, max_results);
+  for (int i = 0; i < n; i++)
+    morph_view(ctx, hits[i], &out[i]);
+  return n;
+}
+
 int reader_lex_lookup(reader_ctx *ctx, const char *lemma, reader_lex_entry *out,
                       int max_results) {
-  int n = lex_bsearch(ctx, lemma, out, max_results);
-  if (n > 0)
-    return n;
-
-  size_t len = strlen(lemma);
-  if (len > 1 && lemma[len - 1] >= '0' && lemma[len - 1] <= '9') {
-    char stripped[256];
-    if (len < sizeof(stripped)) {
-      memcpy(stripped, lemma, len);
-      stripped[len] = '\0';
-      size_t end = len;
-      while (end > 0 && stripped[end - 1] >= '0' && stripped[end - 1] <= '9')
-        end--;
-      if (end > 0 && end < len) {
-        stripped[end] = '\0';
-        n = lex_bsearch(ctx, stripped, out, max_results);
-      }
+  uint32_t hits[PRDB_MAX_HITS];
+  int n = tiered_find(ctx, 1, lemma, hits, max_results);
+  for (int i = 0; i < n; i++)
+    lex_view(ctx, hits[i], &out[i]);
+  return n;
+}
+
+/* sign of browse entry j's key, cut to the prefix's length, against the
+ * prefix.  a prefix that fits the key prefixes never reads the pool */
+static int browse_cmp(reader_ctx *ctx, const char *key, size_t len,
+                      const prdb_key *qk, uint32_t j) {
+  int c = memcmp(&ctx->browse_keys[j], qk,
+                 len < PRDB_KEY_LEN ? len : PRDB_KEY_LEN);
+  if (c || len <= PRDB_KEY_LEN)
+    return c;
+  char probe[PRDB_NORM_KEY_MAX];
+  uint32_t i = ctx->browse[j];
+  if (i >= ctx->hdr.num_lex)
+    return -1;
+  const char *s = pool(ctx, ctx->lexicon[i].lemma_off);
+  if (!s)
+    return PRDB_UNREAD;
+  if (!lookup_key(ctx, s, (int)ctx->hdr.browse_tier, probe))
+    return -1;
+  return strncmp(probe, key, len);
+}
+
+/* the first browse entry at or past the prefix, or past it with `after`;
+ * -1 when a lemma on the way cannot be read */
+static int64_t browse_bound(reader_ctx *ctx, const char *key, size_t len,
+                            const prdb_key *qk, uint32_t lo, int after) {
+  uint32_t hi = ctx->hdr.num_browse;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    int c = browse_cmp(ctx, key, len, qk, mid);
+    if (c == PRDB_UNREAD)
+      return -1;
+    if (c < 0 || (after && c == 0))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+int reader_lex_prefix(reader_ctx *ctx, const char *prefix, int first,
+                      reader_lex_entry *out, int max_results, int *total) {
+  *total = 0;
+  char key[PRDB_NORM_KEY_MAX];
+  if (!lookup_key(ctx, prefix, (int)ctx->hdr.browse_tier, key))
+    return 0;
+  size_t len = strlen(key);
+  prdb_key qk;
+  make_key(key, &qk);
+
+  int64_t lo = browse_bound(ctx, key, len, &qk, 0, 0);
+  if (lo < 0)
+    return 0;
+  int64_t hi = browse_bound(ctx, key, len, &qk, (uint32_t)lo, 1);
+  if (hi < 0)
+    return 0;
+  *total = (int)(hi - lo);
+  int n = 0;
+  for (uint32_t j = (uint32_t)lo + (uint32_t)(first > 0 ? first : 0);
+       j < hi && n < max_results; j++) {
+    if (ctx->browse[j] < ctx->hdr.num_lex)
+      lex_view(ctx, ctx->browse[j], &out[n++]);
+  }
+  return n;
+}
+
+/* the lex entry an analysis was linked to at build time */
+int reader_morph_lex(reader_ctx *ctx, const reader_morph *m,
+                     reader_lex_entry *out) {
+  if (m->lex_idx < 0)
+    return 0;
+  lex_view(ctx, (uint32_t)m->lex_idx, out);
+  return 1;
+}
+
+const char *reader_lex_definition(reader_ctx *ctx, const reader_lex_entry *e) {
+  if (e->idx < 0 || (uint32_t)e->idx >= ctx->hdr.num_lex)
+    return "";
+  return pool_view(ctx, ctx->lexicon[e->idx].def_off, READER_FRAME_LOOKUP);
+}
+
+
+/* a posting list streamed off the card through the packed-block buffer,
+ * a block's worth at a time */
+typedef struct {
+  uint32_t off, end; /* file range still to read */
+  uint32_t pos, len; /* bytes of it in ctx->packed */
+} prdb_postings;
+
+static int post_byte(reader_ctx *ctx, prdb_postings *p) {
+  if (p->pos == p->len) {
+    uint32_t n = p->end - p->off;
+    if (n > ctx->hdr.max_block)
+      n = ctx->hdr.max_block;
+    if (!n || fseek(ctx->file, (long)p->off, SEEK_SET) != 0 ||
+        fread(ctx->packed, 1, n, ctx->file) != n)
+      return -1;
+    p->off += n;
+    p->pos = 0;
+    p->len = n;
+  }
+  return ctx->packed[p->pos++];
+}
+
+static int post_varint(reader_ctx *ctx, prdb_postings *p, uint32_t *out) {
+  uint32_t v = 0;
+  for (int shift = 0; shift < 32; shift += 7) {
+    int b = post_byte(ctx, p);
+    if (b < 0)
+      return 0;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *out = v;
+      return 1;
     }
   }
+  return 0;
+}
+
+/* the term's index among the kind's run, -1 if the word never occurs */
+static int search_term(reader_ctx *ctx, int kind, const char *key) {
+  int first = kind == READER_SEARCH_LEMMA ? 0 : (int)ctx->hdr.num_lemma_terms;
+  int lo = first;
+  int hi = first + (int)(kind == READER_SEARCH_LEMMA ? ctx->hdr.num_lemma_terms
+                                                    : ctx->hdr.num_form_terms) -
+           1;
+  prdb_key qk;
+  make_key(key, &qk);
+  while (lo <= hi) {
+    int mid = lo + (hi - lo) / 2;
+    int cmp = key_cmp(ctx, key, &qk, ctx->term_keys, mid,
+                      ctx->terms[mid].key_off);
+    if (cmp == PRDB_UNREAD)
+      return -1;
+    if (cmp < 0)
+      hi = mid - 1;
+    else if (cmp > 0)
+      lo = mid + 1;
+    else
+      return mid;
+  }
+  return -1;
+}
+
+int reader_search(reader_ctx *ctx, int kind, const char *word,
+                  reader_pos *out, int max_results) {
+  char key[PRDB_NORM_KEY_MAX];
+  if (!lookup_key(ctx, word, PRDB_TIER_NORM, key))
+    return 0;
+  int t = search_term(ctx, kind, key);
+  if (t < 0)
+    return 0;
+
+  /* a list ends where the next term's begins */
+  uint32_t num_terms = ctx->hdr.num_lemma_terms + ctx->hdr.num_form_terms;
+  uint32_t end = (uint32_t)t + 1 < num_terms ? ctx->terms[t + 1].post_off
+                                             : ctx->hdr.postings_size;
+  if (ctx->terms[t].post_off > end || end > ctx->hdr.postings_size)
+    return 0;
+  prdb_postings p = {ctx->hdr.postings_off + ctx->terms[t].post_off,
+                     ctx->hdr.postings_off + end, 0, 0};
+
+  uint32_t total, text = 0;
+  if (!post_varint(ctx, &p, &total))
+    return 0;
+  int n = 0;
+  for (uint32_t i = 0; i < total && n < max_results; i++) {
+    uint32_t gap;
+    if (!post_varint(ctx, &p, &gap))
+      break;
+    text += gap;
+    if (text >= ctx->hdr.num_texts)
+      break;
+    out[n].book = ctx->texts[text].book;
+    out[n].line = ctx->texts[text].line;
+    n++;
+  }
+  return (int)total;
+}
+
+int reader_concordance(reader_ctx *ctx, const char *lemma,
+                       reader_occurrence *out, int max_results, int *total) {
+  *total = 0;
+  char key[PRDB_NORM_KEY_MAX];
+  if (!lookup_key(ctx, lemma, PRDB_TIER_NORM, key))
+    return 0;
+  int t = search_term(ctx, READER_SEARCH_LEMMA, key);
+  if (t < 0)
+    return 0;
+
+  uint32_t lines = ctx->hdr.conc_lines;
+  const uint32_t *rec = ctx->conc + (size_t)t * (1 + 2 * lines);
+  *total = (int)rec[0];
+  int n = 0;
+  for (uint32_t i = 0; i < lines && n < max_results; i++) {
+    uint32_t text = rec[1 + 2 * i];
+    if (text >= ctx->hdr.num_texts)
+      break;
+    out[n].pos.book = ctx->texts[text].book;
+    out[n].pos.line = ctx->texts[text].line;
+    out[n].kwic = pool_view(ctx, rec[2 + 2 * i], READER_FRAME_LOOKUP);
+    n++;
+  }
   return n;
 }
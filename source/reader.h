@@ -5,37 +5,112 @@
 
 typedef struct reader_ctx reader_ctx;
 
+/* lines, analyses and lex entries are views: their strings point into
+ * decoded pool blocks.  a block stays decoded until the frame its views
+ * were handed out in is released with reader_frame(); line views belong
+ * to the page frame, morph and lex views to the lookup frame.  passes over
+ * a whole book take theirs in the scan frame, so they never hold the
+ * page's blocks back or pile up behind it.  the warm frame holds the
+ * blocks of the pages a key press would turn to, read ahead of it. */
+enum {
+  READER_FRAME_PAGE,
+  READER_FRAME_LOOKUP,
+  READER_FRAME_SCAN,
+  READER_FRAME_WARM,
+};
+
 typedef struct {
   int book;
   int line;
-  char text[2048];
+  const char *text;
 } reader_line;
 
+enum {
+  READER_LEX_NONE = -1, /* the lemma has no lex entry */
+};
+
 typedef struct {
-  char form[256];
-  char lemma[256];
-  char postag[16];
-  char parse_str[256];
+  const char *form;
+  const char *lemma;
+  const char *postag;
+  int lex_idx;
 } reader_morph;
 
 typedef struct {
-  char lemma[256];
-  char short_def[1024];
-  char definition[8192];
+  const char *lemma;
+  const char *short_def;
+  int idx; /* for reader_lex_definition() */
 } reader_lex_entry;
 
 reader_ctx *reader_open(const char *db_path);
 void reader_close(reader_ctx *ctx);
 
+void reader_frame(reader_ctx *ctx, int frame);
+
 int reader_get_lines(reader_ctx *ctx, const char *work, int book,
                      int start_line, int count, reader_line *out);
+/* reader_get_lines with views in the scan frame */
+int reader_scan_lines(reader_ctx *ctx, const char *work, int book,
+                      int start_line, int count, reader_line *out);
+/* reader_get_lines with views in the warm frame */
+int reader_warm_lines(reader_ctx *ctx, const char *work, int book,
+                      int start_line, int count, reader_line *out);
 int reader_book_count(reader_ctx *ctx, const char *work);
 int reader_max_line(reader_ctx *ctx, const char *work, int book);
 
+/* the exact spelling first; failing that, the entries that agree with it
+ * once punctuation, digits, elision marks and grave accents are set
+ * aside, then once every diacritic and case is */
 int reader_morph_lookup(reader_ctx *ctx, const char *form, reader_morph *out,
                         int max_results);
+/* analyses of the first word overlapping bytes [off, off + len) of
+ * book:line's text, the treebank's reading in context first: a tapped
+ * group like “λόγον” or (ἄνδρα) finds the word inside its punctuation.  0
+ * when the file has no token for it */
+int reader_token_lookup(reader_ctx *ctx, int book, int line, int off, int len,
+                        reader_morph *out, int max_results);
 
+/* the same tiers; a numbered treebank lemma lands in the second */
 int reader_lex_lookup(reader_ctx *ctx, const char *lemma, reader_lex_entry *out,
                       int max_results);
+/* the lex entries whose lemma starts with `prefix` once every diacritic
+ * and case is set aside, in that key's order, from the first'th on.
+ * *total is how many there are in all, found from the ends of the run
+ * without walking it */
+int reader_lex_prefix(reader_ctx *ctx, const char *prefix, int first,
+                      reader_lex_entry *out, int max_results, int *total);
+int reader_morph_lex(reader_ctx *ctx, const reader_morph *m,
+                     reader_lex_entry *out);
+/* the full entry lives in its own part of the pool; it is only decoded
+ * when asked for */
+const char *reader_lex_definition(reader_ctx *ctx, const reader_lex_entry *e);
+
+enum {
+  READER_SEARCH_LEMMA,
+  READER_SEARCH_FORM,
+};
+
+typedef struct {
+  int book;
+  int line;
+} reader_pos;
+
+/* the lines a lemma or a word form occurs in, in text order, keyed like
+ * the normalized lookup tier; at most max_results of them land in out.
+ * returns how many there are in all */
+int reader_search(reader_ctx *ctx, int kind, const char *word,
+                  reader_pos *out, int max_results);
+
+typedef struct {
+  reader_pos pos;
+  const char *kwic; /* the word in a few words of its line */
+} reader_occurrence;
+
+/* the first lines a lemma occurs in, each with a snippet, as the file
+ * keeps them for the lookup screen: no posting list is read.  *total is
+ * how many lines there are in all.  returns how many landed in out; the
+ * snippets are views into the lookup frame */
+int reader_concordance(reader_ctx *ctx, const char *lemma,
+                       reader_occurrence *out, int max_results, int *total);
 
 void reader_format_postag(const char *postag, char *out, size_t out_size);
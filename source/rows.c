@@ -0,0 +1,157 @@
+#include "rows.h"
+#include "ui.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  const tr_font *font;
+  int book; /* 0 = free */
+  int count;
+  int cap;
+  int done;   /* the whole book is counted */
+  int failed; /* out of memory: the table is left as it is */
+  uint32_t stamp;
+  uint16_t *line;
+  uint32_t *start; /* start[i]: row line[i] begins on; start[count]: rows
+                      counted so far */
+} rows_table;
+
+static rows_table s_tabs[ROWS_TABLES];
+static uint32_t s_clock;
+
+static rows_table *rows_find(const tr_font *f, int book) {
+  for (int i = 0; i < ROWS_TABLES; i++) {
+    if (s_tabs[i].book == book && s_tabs[i].font == f) {
+      s_tabs[i].stamp = ++s_clock;
+      return &s_tabs[i];
+    }
+  }
+  return nil;
+}
+
+/* takes over the least recently used table */
+static rows_table *rows_new(const tr_font *f, int book) {
+  rows_table *t = &s_tabs[0];
+  for (int i = 1; i < ROWS_TABLES && t->book; i++) {
+    if (!s_tabs[i].book || s_tabs[i].stamp < t->stamp)
+      t = &s_tabs[i];
+  }
+  free(t->line);
+  free(t->start);
+  memset(t, 0, sizeof(*t));
+  t->start = (uint32_t *)malloc(sizeof(*t->start));
+  if (!t->start)
+    return nil;
+  t->start[0] = 0;
+  t->font = f;
+  t->book = book;
+  t->stamp = ++s_clock;
+  return t;
+}
+
+static int rows_grow(rows_table *t, int need) {
+  if (need <= t->cap)
+    return 1;
+  int cap = t->cap ? t->cap * 2 : 256;
+  while (cap < need)
+    cap *= 2;
+  uint16_t *line = (uint16_t *)realloc(t->line, cap * sizeof(*line));
+  if (!line)
+    return 0;
+  t->line = line;
+  uint32_t *start = (uint32_t *)realloc(t->start, (cap + 1) * sizeof(*start));
+  if (!start)
+    return 0;
+  t->start = start;
+  t->cap = cap;
+  return 1;
+}
+
+int rows_idle(void) {
+  if (!g_font || g_book < 1)
+    return 0;
+  rows_table *t = rows_find(g_font, g_book);
+  if (!t)
+    t = rows_new(g_font, g_book);
+  if (!t || t->done || t->failed)
+    return 0;
+  if (!rows_grow(t, t->count + ROWS_IDLE_LINES)) {
+    t->failed = 1;
+    return 0;
+  }
+
+  int from = t->count ? t->line[t->count - 1] + 1 : 1;
+  reader_line lines[ROWS_IDLE_LINES];
+  int n = reader_scan_lines(g_ctx, CORPUS_WORK, g_book, from, ROWS_IDLE_LINES,
+                            lines);
+  for (int i = 0; i < n; i++) {
+    int x = line_text_x(lines[i].line);
+    int rows = tr_count_wrapped_lines(g_font, x, x, TR_SCREEN_W - 2,
+                                      lines[i].text);
+    t->line[t->count] = (uint16_t)lines[i].line;
+    t->start[t->count + 1] = t->start[t->count] + (uint32_t)rows;
+    t->count++;
+  }
+  reader_frame(g_ctx, READER_FRAME_SCAN);
+  if (n < ROWS_IDLE_LINES)
+    t->done = 1;
+  return !t->done;
+}
+
+void rows_forget_font(const tr_font *f) {
+  for (int i = 0; i < ROWS_TABLES; i++) {
+    if (s_tabs[i].font != f)
+      continue;
+    free(s_tabs[i].line);
+    free(s_tabs[i].start);
+    memset(&s_tabs[i], 0, sizeof(s_tabs[i]));
+  }
+}
+
+int rows_total(int book) {
+  rows_table *t = rows_find(g_font, book);
+  return t && t->done ? (int)t->start[t->count] : -1;
+}
+
+/* first counted line at or after `line` */
+static int line_index(const rows_table *t, int line) {
+  int lo = 0, hi = t->count;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (t->line[mid] < line)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+int rows_at(int book, int line) {
+  rows_table *t = rows_find(g_font, book);
+  if (!t)
+    return -1;
+  int i = line_index(t, line);
+  if (i == t->count && !t->done)
+    return -1;
+  return (int)t->start[i];
+}
+
+int rows_locate(int book, int row, int *line, int *row_offset) {
+  rows_table *t = rows_find(g_font, book);
+  if (!t || row < 0 || (uint32_t)row >= t->start[t->count])
+    return 0;
+  /* last line starting at or before the row */
+  int lo = 0, hi = t->count - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (t->start[mid] <= (uint32_t)row)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  *line = t->line[lo];
+  *row_offset = row - (int)t->start[lo];
+  return 1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "text_render.h"
+
+/* where every line of a book starts in wrapped rows, for one font: the
+ * row count of each line added up from the top of the book.  tables are
+ * counted a few lines per idle frame by rows_idle(), for the font and
+ * book on show; the queries answer -1 / 0 for what is not counted yet. */
+
+enum {
+  ROWS_TABLES = 4,      /* (font, book) tables kept at once */
+  ROWS_IDLE_LINES = 16, /* lines counted per idle frame */
+};
+
+/* counts the next lines of the current font and book's table.  returns 1
+ * while lines are left to count */
+int rows_idle(void);
+
+/* drops the tables counted for `f`, before it is freed */
+void rows_forget_font(const tr_font *f);
+
+int rows_total(int book);
+/* the absolute row book:line starts on; a missing line answers for the
+ * next one */
+int rows_at(int book, int line);
+/* the line holding absolute `row`, and the row within it */
+int rows_locate(int book, int row, int *line, int *row_offset);
@@ -65,7 +65,9 @@ void save_state(void) {
   sv.g_fullscreen = (uint8_t)g_fullscreen;
   sv.g_palette_idx = (uint8_t)g_palette_idx;
   sv.cur_book = (int16_t)g_book;
-  sv.g_font_family = (uint8_t)g_font_family;
+  /* a family still loading is the one picked */
+  sv.g_font_family =
+      (uint8_t)(g_font_next >= 0 ? g_font_next : g_font_family);
   if (g_book >= 1 && g_book <= MAX_BOOKS)
     g_book_lines[g_book - 1] = (int16_t)g_line_num;
   memcpy(sv.g_book_lines, g_book_lines, sizeof(g_book_lines));
@@ -7,7 +7,7 @@
 void draw_bar(void) {
   tr_select(TR_SCREEN_BOTTOM);
 
-  const tr_font *bf = g_fonts[1];
+  const tr_font *bf = ui_font(UI_ZOOM);
   int lh = bf->glyph_h + 1;
   int bar_h = lh * 3 + 6;
   int bar_y = TR_SCREEN_H - bar_h;
@@ -47,14 +47,22 @@ app_state_t bar_dismiss(void) {
 }
 
 
+/* the zoom only moves once its font is in: a size that fails to load
+ * leaves the page as it was */
+static void zoom_to(int z) {
+  tr_font *f = font_get(g_font_family, z);
+  if (f != g_all_fonts[g_font_family][z])
+    return;
+  g_zoom_level = z;
+  g_font = f;
+  recompute_page_lines();
+  show_text();
+}
+
 app_state_t on_bar_L(app_state_t s) {
   (void)s;
-  if (g_zoom_level > 0) {
-    g_zoom_level--;
-    g_font = g_fonts[g_zoom_level];
-    recompute_page_lines();
-    show_text();
-  }
+  if (g_zoom_level > 0)
+    zoom_to(g_zoom_level - 1);
   g_bar_timer = BAR_TIMEOUT_FRAMES;
   draw_bar();
   return ST_BAR;
@@ -62,12 +70,8 @@ app_state_t on_bar_L(app_state_t s) {
 
 app_state_t on_bar_R(app_state_t s) {
   (void)s;
-  if (g_zoom_level < NUM_ZOOM_LEVELS - 1) {
-    g_zoom_level++;
-    g_font = g_fonts[g_zoom_level];
-    recompute_page_lines();
-    show_text();
-  }
+  if (g_zoom_level < NUM_ZOOM_LEVELS - 1)
+    zoom_to(g_zoom_level + 1);
   g_bar_timer = BAR_TIMEOUT_FRAMES;
   draw_bar();
   return ST_BAR;
@@ -124,10 +128,64 @@ enum {
   TAB_Y = 2,
 };
 
+static void fmt_ms(uint32_t ticks, char *buf, int bufsz) {
+  uint32_t us = timerTicks2usec(ticks);
+  snprintf(buf, bufsz, "%lu.%02lu", (unsigned long)(us / 1000),
+           (unsigned long)(us % 1000 / 10));
+}
+
+enum {
+  PROF_COL_X = 72,
+  PROF_COL_W = 46,
+};
+
+/* one probe per row: name, then last/min/avg/max in ms */
+static int draw_prof_table(const tr_font *sf, int y, uint16_t head,
+                           uint16_t body) {
+  static const char *cols[4] = {"last", "min", "avg", "max"};
+  int lh = sf->glyph_h + 2;
+  tr_draw_text(sf, 4, y, "ms", head);
+  for (int c = 0; c < 4; c++)
+    tr_draw_text(sf, PROF_COL_X + c * PROF_COL_W, y, cols[c], head);
+  y += lh;
+
+  for (int i = 0; i < PROF_COUNT; i++) {
+    prof_stats st;
+    if (!prof_get(i, &st))
+      continue;
+    uint32_t v[4] = {st.last, st.min, st.avg, st.max};
+    tr_draw_text(sf, 4, y, g_prof_names[i], body);
+    for (int c = 0; c < 4; c++) {
+      char buf[16];
+      fmt_ms(v[c], buf, sizeof(buf));
+      tr_draw_text(sf, PROF_COL_X + c * PROF_COL_W, y, buf, body);
+    }
+    y += lh;
+  }
+  return y;
+}
+
+/* top-screen corner copy of the Logs tab table, redrawn with each page */
+void draw_prof_overlay(void) {
+  const palette_t *p = active_palette();
+  const tr_font *sf = ui_font(0);
+  int lh = sf->glyph_h + 2;
+  int h = lh * (PROF_COUNT + 1) + 2;
+  int y = TR_SCREEN_H - h;
+  tr_select(TR_SCREEN_TOP);
+  tr_fill_rect(0, y, TR_SCREEN_W, h, pal_ui_bg(p));
+  tr_draw_hline(0, y, TR_SCREEN_W, p->num);
+  draw_prof_table(sf, y + 2, p->num, p->hl);
+}
+
 static void draw_tab_logs(const tr_font *sf, int content_y) {
   const palette_t *p = active_palette();
   int lh = sf->glyph_h + 2;
-  int y = content_y + 2;
+  int y = draw_prof_table(sf, content_y + 2, p->num, p->hl);
+  tr_draw_text(sf, 4, y, g_prof_overlay ? "A hide overlay" : "A show overlay",
+               p->num);
+  y += lh;
+
   int max_lines = (TR_SCREEN_H - y - 4) / lh;
 
   int start = g_log_count - max_lines;
@@ -252,9 +310,13 @@ static void draw_tab_font(const tr_font *sf, int content_y) {
 
     tr_draw_text(sf, 18, row_y + 3, g_font_family_names[i], label_col);
 
-    const tr_font *preview = g_all_fonts[i][g_zoom_level];
+    /* a family not loaded yet shows up once an idle frame has read it */
+    const tr_font *preview = font_ready(i, g_zoom_level);
     int sample_y = row_y + 2;
-    tr_draw_text(preview, 100, sample_y, "\xce\xbc\xe1\xbf\x86\xce\xbd\xce\xb9\xce\xbd", p->text);
+    if (preview)
+      tr_draw_text(preview, 100, sample_y, "\xce\xbc\xe1\xbf\x86\xce\xbd\xce\xb9\xce\xbd", p->text);
+    else
+      tr_draw_text(sf, 100, row_y + 3, "...", p->num);
 
     if (i == g_set_cursor) {
       tr_draw_hline(0, row_y, TR_SCREEN_W, p->num);
@@ -275,7 +337,7 @@ void draw_settings(void) {
   tr_select(TR_SCREEN_BOTTOM);
   tr_clear(p->bg);
 
-  const tr_font *sf = g_fonts[1];
+  const tr_font *sf = ui_font(UI_ZOOM);
 
   static const char *tab_names[NUM_TABS] = {"Info", "Colors", "Font", "Logs"};
   int tab_w = TR_SCREEN_W / NUM_TABS;
@@ -312,9 +374,11 @@ void preview_top(void) {
   int line_h = g_font->glyph_h + 1;
   int half = TR_SCREEN_H / 2;
 
-  static reader_line pv[MAX_PAGE_LINES];
-  int pn =
-      reader_get_lines(g_ctx, CORPUS_WORK, g_book, g_line_num, g_page_lines, pv);
+  /* the preview's views are let go once it is drawn: they are not the
+   * page's */
+  reader_line pv[MAX_PAGE_LINES];
+  int pn = reader_scan_lines(g_ctx, CORPUS_WORK, g_book, g_line_num,
+                             g_page_lines, pv);
   if (pn > MAX_PAGE_LINES)
     pn = MAX_PAGE_LINES;
 
@@ -353,28 +417,30 @@ void preview_top(void) {
     }
     first_word[wi] = '\0';
   }
+  reader_frame(g_ctx, READER_FRAME_SCAN);
 
   y = half + 2;
   if (first_word[0]) {
-    static reader_morph morphs[4];
+    reader_morph morphs[4];
+    reader_frame(g_ctx, READER_FRAME_LOOKUP);
     int nm = reader_morph_lookup(g_ctx, first_word, morphs, 4);
 
     tr_draw_text(g_font, 4, y, first_word, p->hl);
     y += line_h;
 
     if (nm > 0) {
-      tr_draw_text(g_font, 12, y, morphs[0].parse_str, p->hl);
+      char buf[MAX_RESULT_LEN];
+      reader_format_postag(morphs[0].postag, buf, sizeof(buf));
+      tr_draw_text(g_font, 12, y, buf, p->hl);
       y += line_h;
 
-      char arrow[4 + sizeof(morphs[0].lemma)];
-      snprintf(arrow, sizeof(arrow), "-> %s", morphs[0].lemma);
-      tr_draw_text(g_font, 12, y, arrow, p->text);
+      snprintf(buf, sizeof(buf), "-> %s", morphs[0].lemma);
+      tr_draw_text(g_font, 12, y, buf, p->text);
       y += line_h;
 
-      static reader_lex_entry lex[1];
-      int nl = reader_lex_lookup(g_ctx, morphs[0].lemma, lex, 1);
-      if (nl > 0 && lex[0].short_def[0]) {
-        tr_draw_text_wrap(g_font, 12, 16, y, TR_SCREEN_W - 4, lex[0].short_def,
+      reader_lex_entry lex;
+      if (reader_morph_lex(g_ctx, &morphs[0], &lex) > 0 && lex.short_def[0]) {
+        tr_draw_text_wrap(g_font, 12, 16, y, TR_SCREEN_W - 4, lex.short_def,
                           p->text);
       }
     } else {
@@ -423,10 +489,7 @@ app_state_t on_settings_dismiss(app_state_t s) {
 static void apply_font_family(int fam) {
   if (fam < 0 || fam >= NUM_FONT_FAMILIES)
     fam = 0;
-  g_font_family = fam;
-  memcpy(g_fonts, g_all_fonts[g_font_family], sizeof(g_fonts));
-  g_font = g_fonts[g_zoom_level];
-  recompute_page_lines();
+  font_switch(fam);
 }
 
 app_state_t on_settings_A(app_state_t s) {
@@ -439,6 +502,8 @@ app_state_t on_settings_A(app_state_t s) {
       g_palette_idx = 0;
   } else if (g_set_tab == 2) {
     apply_font_family(g_set_cursor);
+  } else {
+    g_prof_overlay = !g_prof_overlay;
   }
   draw_settings();
   preview_top();
@@ -567,7 +632,7 @@ app_state_t on_settings_TOUCH(app_state_t s) {
       }
     }
   } else if (g_set_tab == 2) {
-    int lh_title = g_fonts[1]->glyph_h + 6;
+    int lh_title = ui_font(UI_ZOOM)->glyph_h + 6;
     int base_y = content_y + 4 + lh_title;
     for (int i = 0; i < NUM_FONT_FAMILIES; i++) {
       int row_y = base_y + i * FONT_ROW_H;
@@ -624,7 +689,7 @@ static void pick_layout(const tr_font *sf, int *out_field_y, int *out_preview_y,
 
 void draw_picker(void) {
   const palette_t *ap = active_palette();
-  const tr_font *sf = g_fonts[1];
+  const tr_font *sf = ui_font(UI_ZOOM);
   int lh = sf->glyph_h + 1;
 
   tr_select(TR_SCREEN_BOTTOM);
@@ -776,7 +841,7 @@ app_state_t on_picker_TOUCH(app_state_t s) {
   touchRead(&touch);
   int tx = touch.px, ty = touch.py;
 
-  const tr_font *sf = g_fonts[1];
+  const tr_font *sf = ui_font(UI_ZOOM);
   int field_y, preview_y, slider_y0;
   pick_layout(sf, &field_y, &preview_y, &slider_y0);
 
@@ -1,5 +1,7 @@
 #include "text_render.h"
 #include "common.h"
+#include "profile.h"
+#include "tile_canvas.h"
 
 #include <nds.h>
 #include <stdio.h>
@@ -11,17 +13,167 @@ enum {
   TR_FALLBACK_ADV = 4,
   PFNT_HEADER_SIZE = 16,
   HEARTBEAT_SIZE = 4,
+  TR_LAYOUT_SLOTS = 160, /* the reading window and the pages warmed by it */
+  TR_DMA_MIN_BYTES = 64, /* shorter fills stay on the cpu */
+  /* bottom rows copied per vblank, about 1.5 ms of dma: a whole screen
+   * would outlast vblank with the cpu stalled */
+  TR_VBLANK_ROWS = 96,
 };
 
 static int s_top_bg;
-static uint16_t *s_top_buf[2];
 static int s_top_back = 0;
 
+static int s_selected = TR_SCREEN_TOP;
+
+/* tr_flip only schedules the swap; tr_vblank performs it.  drawing to the
+ * top screen in between would land in the buffer still on show, so
+ * tr_flip lets go of the top screen and tr_select waits for the swap. */
+static volatile int s_flip_pending;
+static int s_flip_base;
+
+static void wait_flip(void) {
+  while (s_flip_pending)
+    swiWaitForVBlank();
+}
+
+/* rows outside [s_clip_y0, s_clip_y1) are left alone */
+static int s_clip_y0 = 0;
+static int s_clip_y1 = TR_SCREEN_H;
+
+#ifdef LEXIS_TILES
+/* `make TILES=1`: both screens are 8bpp tile canvases instead of 16bpp
+ * bitmaps.  vram layout: top maps at bases 0/1 with tiles at 16K/96K in
+ * banks A+B, bottom map at base 0 with tiles at 64K in bank C, clear of
+ * the boot console's map at base 31. */
+enum {
+  TOP_TILE_BASE0 = 1,
+  TOP_TILE_BASE1 = 6,
+  BOT_TILE_BASE = 4,
+  TOP_CLEAR_IDX0 = 1,
+  TOP_CLEAR_IDX1 = 2,
+  BOT_CLEAR_IDX = 1,
+};
+
+static tc_palette s_top_pal, s_bot_pal;
+static tc_canvas s_top_tc[2];
+static tc_canvas s_bot_tc;
+static tc_canvas *tc_bot = nil;
+static tc_canvas *tc = nil;
+
+static inline int drawable(void) { return tc != nil; }
+
+void tr_init_fb(void) {
+  videoSetMode(MODE_0_2D);
+  vramSetBankA(VRAM_A_MAIN_BG);
+  vramSetBankB(VRAM_B_MAIN_BG);
+
+  s_top_bg = bgInit(0, BgType_Text8bpp, BgSize_T_256x256, 0, TOP_TILE_BASE0);
+  uint16_t *map = bgGetMapPtr(s_top_bg);
+  uint16_t *tiles = bgGetGfxPtr(s_top_bg);
+
+  tc_palette_init(&s_top_pal, BG_PALETTE, TOP_CLEAR_IDX1 + 1);
+  tc_init(&s_top_tc[0], &s_top_pal, s_top_bg, 0, TOP_TILE_BASE0, map, tiles,
+          TOP_CLEAR_IDX0);
+  tc_init(&s_top_tc[1], &s_top_pal, s_top_bg, 1, TOP_TILE_BASE1,
+          map + 0x800 / 2,
+          tiles + (TOP_TILE_BASE1 - TOP_TILE_BASE0) * 0x4000 / 2,
+          TOP_CLEAR_IDX1);
+
+  s_top_back = 1;
+  tc = &s_top_tc[s_top_back];
+}
+
+void tr_init_fb_sub(void) {
+  videoSetModeSub(MODE_0_2D);
+  vramSetBankC(VRAM_C_SUB_BG);
+
+  int bg = bgInitSub(0, BgType_Text8bpp, BgSize_T_256x256, 0, BOT_TILE_BASE);
+  tc_palette_init(&s_bot_pal, BG_PALETTE_SUB, BOT_CLEAR_IDX + 1);
+  tc_init(&s_bot_tc, &s_bot_pal, bg, 0, BOT_TILE_BASE, bgGetMapPtr(bg),
+          bgGetGfxPtr(bg), BOT_CLEAR_IDX);
+  tc_bot = &s_bot_tc;
+}
+
+void tr_select(int screen) {
+  s_selected = screen;
+  if (screen == TR_SCREEN_TOP)
+    wait_flip();
+  tc = (screen == TR_SCREEN_BOTTOM) ? tc_bot : &s_top_tc[s_top_back];
+}
+
+void tr_flip(void) {
+  wait_flip();
+  s_flip_base = s_top_back;
+  s_flip_pending = 1;
+  s_top_back ^= 1;
+  if (s_selected == TR_SCREEN_TOP)
+    tc = nil;
+}
+
+/* canvases are drawn in place, so there is nothing to hand over */
+void tr_present(void) {}
+
+void tr_vblank(void) {
+  if (s_flip_pending) {
+    tc_show(&s_top_tc[s_flip_base]);
+    s_flip_pending = 0;
+  }
+}
+
+void tr_clear(uint16_t color) {
+  if (drawable())
+    tc_clear(tc, color);
+}
+
+/* the canvas has no rows beyond the screen, so no ring to scroll */
+int tr_can_scroll(void) { return 0; }
+
+void tr_scroll_bottom(int origin) { (void)origin; }
+
+void tr_set_clip(int y0, int y1) {
+  s_clip_y0 = y0 < 0 ? 0 : y0;
+  s_clip_y1 = y1 > TR_SCREEN_H ? TR_SCREEN_H : y1;
+}
+#else
+static uint16_t *s_top_buf[2];
+
+/* the bottom screen has only bank C, no room for a second bitmap, so it
+ * is composed in a 128 KB ring in main ram and copied to vram in vblank,
+ * TR_VBLANK_ROWS rows at a time.  rows are tracked in ring coordinates:
+ * drawn since the last present, and presented but not yet copied.
+ * tr_select waits for the copy to finish before the rows are drawn
+ * again. */
+static uint16_t s_bot_ram[TR_RING_H * TR_SCREEN_W] __attribute__((aligned(32)));
+static uint16_t *s_bot_vram;
+static uint32_t s_dirty[TR_RING_H / 32];
+static uint32_t s_ready[TR_RING_H / 32];
+static volatile int s_ready_any;
+static int s_ready_origin;
+static int s_shown_origin;
+
 static uint16_t *fb_bot = nil;
+static int s_bot_bg;
+static int s_bot_origin; /* ring row shown at the top of the bottom screen */
 
 static uint16_t *fb = nil;
+static int s_origin; /* s_bot_origin or 0, following the selection */
 
-static int s_selected = TR_SCREEN_TOP;
+static inline int drawable(void) { return fb != nil; }
+
+/* screen row y of the selected target; the bitmap is a ring of TR_RING_H
+ * rows, so rows above and below the screen land in the hidden part */
+static inline uint16_t *fb_row(int y) {
+  return fb + ((s_origin + y) & (TR_RING_H - 1)) * TR_SCREEN_W;
+}
+
+static inline void mark_rows(int y, int rows) {
+  if (fb != s_bot_ram)
+    return;
+  for (int i = 0; i < rows; i++) {
+    int r = (s_origin + y + i) & (TR_RING_H - 1);
+    s_dirty[r >> 5] |= 1u << (r & 31);
+  }
+}
 
 void tr_init_fb(void) {
   videoSetMode(MODE_5_2D);
@@ -44,39 +196,177 @@ void tr_init_fb_sub(void) {
   videoSetModeSub(MODE_5_2D);
   vramSetBankC(VRAM_C_SUB_BG);
 
-  int bg = bgInitSub(2, BgType_Bmp16, BgSize_B16_256x256, 0, 0);
-  fb_bot = bgGetGfxPtr(bg);
+  s_bot_bg = bgInitSub(2, BgType_Bmp16, BgSize_B16_256x256, 0, 0);
+  s_bot_vram = bgGetGfxPtr(s_bot_bg);
+  fb_bot = s_bot_ram;
 
-  bgSetRotateScale(bg, 0, 1 << 8, 1 << 8);
+  bgSetRotateScale(s_bot_bg, 0, 1 << 8, 1 << 8);
+  bgWrapOn(s_bot_bg);
   bgUpdate();
 }
 
 void tr_select(int screen) {
   s_selected = screen;
+  if (screen == TR_SCREEN_TOP)
+    wait_flip();
+  else
+    while (s_ready_any)
+      swiWaitForVBlank();
   fb = (screen == TR_SCREEN_BOTTOM) ? fb_bot : s_top_buf[s_top_back];
+  s_origin = (screen == TR_SCREEN_BOTTOM) ? s_bot_origin : 0;
 }
 
 void tr_flip(void) {
-  bgSetMapBase(s_top_bg, s_top_back * 8);
-  bgUpdate();
+  wait_flip();
+  s_flip_base = s_top_back * 8;
+  s_flip_pending = 1;
   s_top_back ^= 1;
   if (s_selected == TR_SCREEN_TOP)
-    fb = s_top_buf[s_top_back];
+    fb = nil;
 }
 
-void tr_clear(uint16_t color) {
-  if (!fb)
+/* hands the bottom rows drawn so far, and the scroll position they were
+ * drawn for, to the next vblank.  the data cache is only 4 KB, so past
+ * that size cleaning all of it beats walking the range. */
+void tr_present(void) {
+  uint32_t any = 0;
+  int rows = 0;
+  for (int w = 0; w < TR_RING_H / 32; w++) {
+    any |= s_dirty[w];
+    rows += __builtin_popcount(s_dirty[w]);
+  }
+  if (!any && s_bot_origin == s_ready_origin)
+    return;
+
+  if (rows * TR_SCREEN_W * 2 > 4096) {
+    DC_FlushAll();
+  } else {
+    for (int r = 0; r < TR_RING_H; r++)
+      if (s_dirty[r >> 5] & (1u << (r & 31)))
+        DC_FlushRange(s_bot_ram + r * TR_SCREEN_W, TR_SCREEN_W * 2);
+  }
+
+  int ime = enterCriticalSection();
+  for (int w = 0; w < TR_RING_H / 32; w++) {
+    s_ready[w] |= s_dirty[w];
+    s_dirty[w] = 0;
+  }
+  s_ready_origin = s_bot_origin;
+  s_ready_any = 1;
+  leaveCriticalSection(ime);
+}
+
+static void copy_ring_rows(int r, int rows) {
+  dmaCopyWords(0, s_bot_ram + r * TR_SCREEN_W, s_bot_vram + r * TR_SCREEN_W,
+               rows * TR_SCREEN_W * 2);
+}
+
+/* called from the vblank interrupt.  rows go out from the top of the
+ * screen, TR_VBLANK_ROWS a vblank; the scroll position they were drawn
+ * for is only shown once the last of them is copied. */
+void tr_vblank(void) {
+  if (s_flip_pending) {
+    bgSetMapBase(s_top_bg, s_flip_base);
+    s_flip_pending = 0;
+  }
+  if (!s_ready_any)
+    return;
+
+  int run = 0, start = 0, budget = TR_VBLANK_ROWS;
+  for (int i = 0; i <= TR_RING_H; i++) {
+    int r = (s_ready_origin + i) & (TR_RING_H - 1);
+    int hit = i < TR_RING_H && budget &&
+              (s_ready[r >> 5] & (1u << (r & 31)));
+    if (hit) {
+      s_ready[r >> 5] &= ~(1u << (r & 31));
+      budget--;
+      if (run && r == start + run) {
+        run++;
+        continue;
+      }
+    }
+    if (run)
+      copy_ring_rows(start, run);
+    run = hit;
+    start = r;
+  }
+  for (int w = 0; w < TR_RING_H / 32; w++)
+    if (s_ready[w])
+      return;
+
+  if (s_ready_origin != s_shown_origin) {
+    s_shown_origin = s_ready_origin;
+    bgSetScroll(s_bot_bg, 0, s_shown_origin);
+    bgUpdate();
+  }
+  s_ready_any = 0;
+}
+
+/* dma fill pays for its setup after a few words; `make NODMA=1` keeps
+ * every fill on the cpu.  the bottom screen's ram buffer is always filled
+ * by the cpu: dma would go around the data cache. */
+static void fill_words(void *dst, uint32_t fill, size_t bytes) {
+#ifndef LEXIS_NO_DMA
+  if (bytes >= TR_DMA_MIN_BYTES && fb != s_bot_ram) {
+    dmaFillWords(fill, dst, bytes);
     return;
-  uint32_t fill = (uint32_t)color | ((uint32_t)color << 16);
-  uint32_t *p = (uint32_t *)fb;
-  for (int i = 0; i < TR_SCREEN_W * TR_SCREEN_H / 2; i++)
+  }
+#endif
+  uint32_t *p = (uint32_t *)dst;
+  for (size_t i = 0; i < bytes / 4; i++)
     p[i] = fill;
 }
 
+/* whole screen rows [y, y + rows), split where the ring wraps */
+static void fill_rows(int y, int rows, uint32_t fill) {
+  mark_rows(y, rows);
+  int start = (s_origin + y) & (TR_RING_H - 1);
+  int first = TR_RING_H - start;
+  if (first > rows)
+    first = rows;
+  fill_words(fb_row(y), fill, (size_t)first * TR_SCREEN_W * 2);
+  if (rows > first)
+    fill_words(fb_row(y + first), fill,
+               (size_t)(rows - first) * TR_SCREEN_W * 2);
+}
+
+void tr_clear(uint16_t color) {
+  if (!drawable())
+    return;
+  fill_rows(0, TR_SCREEN_H, (uint32_t)color | ((uint32_t)color << 16));
+}
+
+int tr_can_scroll(void) { return 1; }
+
+/* moves the bottom screen's window over the ring; drawing follows it, so
+ * callers keep working in screen coordinates.  the hardware scroll
+ * changes with the next present. */
+void tr_scroll_bottom(int origin) {
+  s_bot_origin = origin & (TR_RING_H - 1);
+  if (s_selected == TR_SCREEN_BOTTOM)
+    s_origin = s_bot_origin;
+}
+
+/* the clip may reach past the screen into the ring's hidden rows, but no
+ * further than one ring */
+void tr_set_clip(int y0, int y1) {
+  if (y1 - y0 > TR_RING_H)
+    y1 = y0 + TR_RING_H;
+  s_clip_y0 = y0;
+  s_clip_y1 = y1;
+}
+#endif
+
 void tr_draw_pixel(int x, int y, uint16_t color) {
-  if (!fb || x < 0 || y < 0 || x >= TR_SCREEN_W || y >= TR_SCREEN_H)
+  if (!drawable() || x < 0 || y < s_clip_y0 || x >= TR_SCREEN_W ||
+      y >= s_clip_y1)
     return;
-  fb[y * TR_SCREEN_W + x] = color;
+#ifdef LEXIS_TILES
+  tc_pixel(tc, x, y, color);
+#else
+  mark_rows(y, 1);
+  fb_row(y)[x] = color;
+#endif
 }
 
 // bresenham
@@ -107,7 +397,7 @@ void tr_draw_line(int x0, int y0, int x1, int y1, uint16_t color) {
 }
 
 void tr_draw_hline(int x, int y, int w, uint16_t color) {
-  if (!fb || y < 0 || y >= TR_SCREEN_H)
+  if (!drawable() || y < s_clip_y0 || y >= s_clip_y1)
     return;
   if (x < 0) {
     w += x;
@@ -115,12 +405,39 @@ void tr_draw_hline(int x, int y, int w, uint16_t color) {
   }
   if (x + w > TR_SCREEN_W)
     w = TR_SCREEN_W - x;
-  uint16_t *row = fb + y * TR_SCREEN_W + x;
-  for (int i = 0; i < w; i++)
-    row[i] = color;
+  if (w <= 0)
+    return;
+#ifdef LEXIS_TILES
+  tc_span(tc, x, y, w, color);
+#else
+  /* halfword edges around a word-aligned middle */
+  mark_rows(y, 1);
+  uint16_t *row = fb_row(y) + x;
+  if (x & 1) {
+    *row++ = color;
+    w--;
+  }
+  fill_words(row, (uint32_t)color | ((uint32_t)color << 16),
+             (size_t)(w & ~1) * 2);
+  if (w & 1)
+    row[w - 1] = color;
+#endif
 }
 
 void tr_fill_rect(int x, int y, int w, int h, uint16_t color) {
+#ifndef LEXIS_TILES
+  /* full-width rects are contiguous rows: one fill per ring segment */
+  if (drawable() && x <= 0 && x + w >= TR_SCREEN_W) {
+    int y1 = y + h;
+    if (y < s_clip_y0)
+      y = s_clip_y0;
+    if (y1 > s_clip_y1)
+      y1 = s_clip_y1;
+    if (y < y1)
+      fill_rows(y, y1 - y, (uint32_t)color | ((uint32_t)color << 16));
+    return;
+  }
+#endif
   for (int row = 0; row < h; row++)
     tr_draw_hline(x, y + row, w, color);
 }
@@ -213,29 +530,68 @@ tr_font *tr_load_font(const char *path) {
   fread(font->glyphs, sizeof(tr_glyph_entry), num_glyphs, f);
 
   size_t bmp_size = (size_t)num_glyphs * glyph_h * row_bytes;
-  font->bitmaps = (uint8_t *)malloc(bmp_size);
-  if (!font->bitmaps) {
-    free(font->glyphs);
-    free(font);
+  uint8_t *bitmaps = (uint8_t *)malloc(bmp_size);
+  font->masks = (uint16_t *)malloc((size_t)num_glyphs * glyph_h * 2);
+  if (!bitmaps || !font->masks || glyph_w > 16) {
+    free(bitmaps);
     fclose(f);
+    tr_free_font(font);
     return nil;
   }
-  fread(font->bitmaps, 1, bmp_size, f);
+  fread(bitmaps, 1, bmp_size, f);
 
   fclose(f);
+
+  /* msb-first bytes -> one lsb-first mask per row, so the blitter can
+   * take pixel pairs straight off the bottom of the word */
+  const uint8_t *src = bitmaps;
+  for (size_t r = 0; r < (size_t)num_glyphs * glyph_h; r++) {
+    uint16_t m = 0;
+    for (int col = 0; col < glyph_w; col++)
+      if (src[col >> 3] & (0x80 >> (col & 7)))
+        m |= (uint16_t)(1u << col);
+    font->masks[r] = m;
+    src += row_bytes;
+  }
+  free(bitmaps);
+
+  for (int i = 0; i < num_glyphs; i++) {
+    uint32_t cp = font->glyphs[i].codepoint;
+    if (cp <= 0xFFFF && !font->page_of[cp >> 8])
+      font->page_of[cp >> 8] = (uint8_t)++font->num_pages;
+  }
+  if (font->num_pages) {
+    size_t pages_size = font->num_pages * sizeof(*font->pages);
+    font->pages = (uint16_t(*)[256])malloc(pages_size);
+    if (!font->pages) {
+      tr_free_font(font);
+      return nil;
+    }
+    memset(font->pages, 0xFF, pages_size); /* TR_NO_GLYPH */
+    for (int i = 0; i < num_glyphs; i++) {
+      uint32_t cp = font->glyphs[i].codepoint;
+      if (cp <= 0xFFFF)
+        font->pages[font->page_of[cp >> 8] - 1][cp & 0xFF] = (uint16_t)i;
+    }
+  }
   return font;
 }
 
+static void layout_forget_font(const tr_font *f);
+
 void tr_free_font(tr_font *f) {
   if (!f)
     return;
-  free(f->bitmaps);
+  layout_forget_font(f);
+  free(f->pages);
+  free(f->masks);
   free(f->glyphs);
   free(f);
 }
 
 
-static const tr_glyph_entry *find_glyph(const tr_font *f, uint32_t cp) {
+static const tr_glyph_entry *find_glyph_bsearch(const tr_font *f,
+                                                uint32_t cp) {
   int lo = 0, hi = (int)f->num_glyphs - 1;
   while (lo <= hi) {
     int mid = (lo + hi) / 2;
@@ -249,45 +605,75 @@ static const tr_glyph_entry *find_glyph(const tr_font *f, uint32_t cp) {
   return nil;
 }
 
-static void blit_glyph(const tr_font *f, const tr_glyph_entry *g, int x, int y,
-                       uint16_t color) {
-  if (!fb)
-    return;
-
-  size_t glyph_offset = (size_t)g->atlas_idx * f->glyph_h * f->row_bytes;
-  const uint8_t *bitmap = f->bitmaps + glyph_offset;
+static inline const tr_glyph_entry *find_glyph(const tr_font *f, uint32_t cp) {
+  if (cp > 0xFFFF)
+    return find_glyph_bsearch(f, cp);
+  unsigned slot = f->page_of[cp >> 8];
+  if (!slot)
+    return nil;
+  uint16_t idx = f->pages[slot - 1][cp & 0xFF];
+  return idx == TR_NO_GLYPH ? nil : &f->glyphs[idx];
+}
 
-  for (int row = 0; row < f->glyph_h; row++) {
-    int py = y + row;
-    if (py < 0) {
-      bitmap += f->row_bytes;
-      continue;
-    }
-    if (py >= TR_SCREEN_H)
-      break;
+/* clipping is settled once per glyph: the row range up front, the column
+ * range as a mask.  pixels then go out in aligned pairs, one 32-bit store
+ * when both are set, which is most of a stem or a bar. */
+ITCM_CODE ARM_CODE static void blit_glyph(const tr_font *f,
+                                          const tr_glyph_entry *g, int x,
+                                          int y, uint16_t color) {
+  if (!drawable() || x >= TR_SCREEN_W || x + f->glyph_w <= 0)
+    return;
 
-    const uint8_t *rowdata = bitmap;
-    bitmap += f->row_bytes;
+  int r0 = y < s_clip_y0 ? s_clip_y0 - y : 0;
+  int r1 = f->glyph_h;
+  if (y + r1 > s_clip_y1)
+    r1 = s_clip_y1 - y;
+  if (r0 >= r1)
+    return;
 
-    for (int col = 0; col < f->glyph_w; col++) {
-      int px = x + col;
-      if (px < 0)
-        continue;
-      if (px >= TR_SCREEN_W)
+  const uint16_t *mask = f->masks + (size_t)g->atlas_idx * f->glyph_h;
+#ifdef LEXIS_TILES
+  tc_blit_rows(tc, mask + r0, r1 - r0, f->glyph_w, x, y + r0, color);
+#else
+  int base = x & ~1; /* even column, also for negative x */
+  int shift = x - base;
+  int skip = 0;
+  uint32_t clip = ~0u;
+  if (base < 0) {
+    skip = -base;
+    base = 0;
+  }
+  if (TR_SCREEN_W - base < 32)
+    clip = (1u << (TR_SCREEN_W - base)) - 1;
+
+  uint32_t pair = (uint32_t)color | ((uint32_t)color << 16);
+  mark_rows(y + r0, r1 - r0);
+
+  for (int row = r0; row < r1; row++) {
+    uint32_t m = (((uint32_t)mask[row] << shift) >> skip) & clip;
+    for (uint32_t *d = (uint32_t *)(fb_row(y + row) + base); m; m >>= 2, d++) {
+      switch (m & 3) {
+      case 1:
+        ((uint16_t *)d)[0] = color;
+        break;
+      case 2:
+        ((uint16_t *)d)[1] = color;
+        break;
+      case 3:
+        *d = pair;
         break;
-
-      if (rowdata[col >> 3] & (0x80 >> (col & 7))) {
-        fb[py * TR_SCREEN_W + px] = color;
       }
     }
   }
+#endif
 }
 
 int tr_draw_text(const tr_font *f, int x, int y, const char *utf8,
                  uint16_t color) {
-  if (!f || !utf8 || !fb)
+  if (!f || !utf8 || !drawable())
     return x;
 
+  prof_begin(PROF_BLIT);
   int chars = 0;
   while (*utf8 && chars < TR_MAX_CHARS) {
     uint32_t cp = utf8_decode(&utf8);
@@ -305,6 +691,7 @@ int tr_draw_text(const tr_font *f, int x, int y, const char *utf8,
       break;
   }
 
+  prof_end(PROF_BLIT);
   return x;
 }
 
@@ -342,6 +729,7 @@ int tr_draw_text_wrap(const tr_font *f, int x_start, int x_indent, int y,
   int rows = 1;
   const char *p = utf8;
 
+  prof_begin(PROF_BLIT);
   while (*p) {
     /* skip spaces, measure them */
     while (*p == ' ' || *p == '\t') {
@@ -372,7 +760,7 @@ int tr_draw_text_wrap(const tr_font *f, int x_start, int x_indent, int y,
     while (p < word_end) {
       uint32_t cp = utf8_decode(&p);
       const tr_glyph_entry *g = find_glyph(f, cp);
-      if (g && fb) {
+      if (g && drawable()) {
         blit_glyph(f, g, x, y, color);
         x += g->advance;
       } else {
@@ -380,6 +768,7 @@ int tr_draw_text_wrap(const tr_font *f, int x_start, int x_indent, int y,
       }
     }
   }
+  prof_end(PROF_BLIT);
   return rows;
 }
 
@@ -473,10 +862,226 @@ int tr_word_at_pos(const tr_font *f, int x_start, int x_indent, int y,
   return 0;
 }
 
+
+static tr_layout s_layouts[TR_LAYOUT_SLOTS];
+static uint32_t s_layout_clock;
+
+static void layout_forget_font(const tr_font *f) {
+  for (int i = 0; i < TR_LAYOUT_SLOTS; i++)
+    if (s_layouts[i].font == f)
+      s_layouts[i].font = nil;
+}
+
+static int layout_push(tr_layout *lo, const tr_glyph_entry *g, int x,
+                       int off, int row, int len) {
+  if (lo->count == lo->cap) {
+    int cap = lo->cap ? lo->cap * 2 : 64;
+    tr_run_glyph *grown =
+        (tr_run_glyph *)realloc(lo->glyphs, (size_t)cap * sizeof(*grown));
+    if (!grown)
+      return 0;
+    lo->glyphs = grown;
+    lo->cap = cap;
+  }
+  tr_run_glyph *rg = &lo->glyphs[lo->count++];
+  rg->g = g;
+  rg->x = (int16_t)x;
+  rg->off = (uint16_t)off;
+  rg->row = (uint8_t)row;
+  rg->len = (uint8_t)len;
+  return 1;
+}
+
+/* same wrapping rules as tr_draw_text_wrap, recorded instead of drawn */
+static void layout_build(tr_layout *lo, const char *utf8) {
+  const tr_font *f = lo->font;
+  int x = lo->x_start;
+  int row = 0;
+  const char *p = utf8;
+
+  lo->count = 0;
+  while (*p && p - utf8 <= UINT16_MAX) {
+    while (*p == ' ' || *p == '\t') {
+      uint32_t cp = utf8_decode(&p);
+      const tr_glyph_entry *g = find_glyph(f, cp);
+      x += g ? g->advance : TR_FALLBACK_ADV;
+    }
+    if (!*p)
+      break;
+    if (*p == '\n') {
+      p++;
+      x = lo->x_indent;
+      row++;
+      continue;
+    }
+
+    const char *word_end;
+    int word_w = measure_word(f, p, &word_end);
+
+    if (x + word_w > lo->max_x && x > lo->x_indent) {
+      x = lo->x_indent;
+      row++;
+    }
+
+    while (p < word_end) {
+      const char *start = p;
+      uint32_t cp = utf8_decode(&p);
+      const tr_glyph_entry *g = find_glyph(f, cp);
+      if (!layout_push(lo, g, x, (int)(start - utf8), row, (int)(p - start)))
+        break;
+      x += g ? g->advance : TR_FALLBACK_ADV;
+    }
+  }
+  lo->rows = (int16_t)(row + 1);
+}
+
+const tr_layout *tr_layout_find(const tr_font *f, uint32_t key, int x_start,
+                                int x_indent, int max_x) {
+  for (int i = 0; i < TR_LAYOUT_SLOTS; i++) {
+    tr_layout *lo = &s_layouts[i];
+    if (lo->font == f && lo->key == key && lo->x_start == x_start &&
+        lo->x_indent == x_indent && lo->max_x == max_x) {
+      lo->stamp = ++s_layout_clock;
+      return lo;
+    }
+  }
+  return nil;
+}
+
+const tr_layout *tr_layout_text(const tr_font *f, uint32_t key, int x_start,
+                                int x_indent, int max_x, const char *utf8) {
+  if (!f || !utf8)
+    return nil;
+  const tr_layout *hit = tr_layout_find(f, key, x_start, x_indent, max_x);
+  if (hit)
+    return hit;
+
+  tr_layout *lo = &s_layouts[0];
+  for (int i = 1; i < TR_LAYOUT_SLOTS && lo->font; i++) {
+    if (!s_layouts[i].font || s_layouts[i].stamp < lo->stamp)
+      lo = &s_layouts[i];
+  }
+
+  lo->font = f;
+  lo->key = key;
+  lo->x_start = (int16_t)x_start;
+  lo->x_indent = (int16_t)x_indent;
+  lo->max_x = (int16_t)max_x;
+  lo->stamp = ++s_layout_clock;
+  layout_build(lo, utf8);
+  return lo;
+}
+
+int tr_draw_layout(const tr_layout *lo, int y, uint16_t color) {
+  if (!lo)
+    return 1;
+  const tr_font *f = lo->font;
+  int line_h = f->glyph_h + 1;
+  prof_begin(PROF_BLIT);
+  for (int i = 0; i < lo->count; i++) {
+    const tr_run_glyph *rg = &lo->glyphs[i];
+    int gy = y + rg->row * line_h;
+    if (gy >= s_clip_y1)
+      break;
+    if (rg->g)
+      blit_glyph(f, rg->g, rg->x, gy, color);
+  }
+  prof_end(PROF_BLIT);
+  return lo->rows;
+}
+
+/* glyphs belong to the same word when their source bytes are adjacent */
+int tr_layout_word_at(const tr_layout *lo, const char *utf8, int y, int px,
+                      int py, char *out, int out_len, int *out_off) {
+  if (!lo || !utf8 || !out || out_len < 2)
+    return 0;
+  int line_h = lo->font->glyph_h + 1;
+  int i = 0;
+  while (i < lo->count) {
+    int first = i;
+    while (i + 1 < lo->count &&
+           lo->glyphs[i].off + lo->glyphs[i].len == lo->glyphs[i + 1].off)
+      i++;
+    const tr_run_glyph *a = &lo->glyphs[first];
+    const tr_run_glyph *b = &lo->glyphs[i];
+    i++;
+
+    int wy = y + a->row * line_h;
+    int x_end = b->x + (b->g ? b->g->advance : TR_FALLBACK_ADV);
+    if (py >= wy && py < wy + line_h && px >= a->x && px < x_end) {
+      int len = b->off + b->len - a->off;
+      if (len >= out_len)
+        len = out_len - 1;
+      memcpy(out, utf8 + a->off, (size_t)len);
+      out[len] = '\0';
+      if (out_off)
+        *out_off = a->off;
+      return 1;
+    }
+  }
+  return 0;
+}
+
 void tr_draw_heartbeat(int frame) {
-  uint16_t *front = s_top_buf[s_top_back ^ 1];
   uint16_t c = (frame & 1) ? TR_WHITE : (TR_ALPHA | 0x001F); /* red */
+#ifdef LEXIS_TILES
+  for (int dy = 0; dy < HEARTBEAT_SIZE; dy++)
+    tc_span(&s_top_tc[s_top_back ^ 1], TR_SCREEN_W - HEARTBEAT_SIZE - 1, dy,
+            HEARTBEAT_SIZE, c);
+#else
+  uint16_t *front = s_top_buf[s_top_back ^ 1];
   for (int dy = 0; dy < HEARTBEAT_SIZE; dy++)
     for (int dx = 0; dx < HEARTBEAT_SIZE; dx++)
       front[(dy)*TR_SCREEN_W + (TR_SCREEN_W - HEARTBEAT_SIZE - 1 + dx)] = c;
+#endif
+}
+
+#ifdef LEXIS_BENCH
+static uint32_t bench_gps(int n, uint32_t ticks) {
+  if (!ticks)
+    ticks = 1;
+  return (uint32_t)((uint64_t)n * BUS_CLOCK / ticks);
+}
+
+/* glyphs/second for the same codepoint stream through both lookups; the
+ * text is decoded up front so only the lookup is timed, and the advance sum
+ * keeps the loops from being optimised away.  returns the glyph count. */
+int tr_bench_lookup(const tr_font *f, const char *utf8, uint32_t *bsearch_gps,
+                    uint32_t *table_gps) {
+  *bsearch_gps = *table_gps = 0;
+
+  int n = 0;
+  for (const char *p = utf8; *p; n++)
+    utf8_decode(&p);
+  uint32_t *cps = (uint32_t *)malloc((size_t)(n ? n : 1) * sizeof(*cps));
+  if (!cps)
+    return 0;
+  const char *p = utf8;
+  for (int i = 0; i < n; i++)
+    cps[i] = utf8_decode(&p);
+
+  volatile uint32_t sink = 0;
+  uint32_t acc = 0;
+
+  cpuStartTiming(0);
+  for (int i = 0; i < n; i++) {
+    const tr_glyph_entry *g = find_glyph_bsearch(f, cps[i]);
+    acc += g ? g->advance : 0;
+  }
+  *bsearch_gps = bench_gps(n, cpuEndTiming());
+  sink += acc;
+
+  acc = 0;
+  cpuStartTiming(0);
+  for (int i = 0; i < n; i++) {
+    const tr_glyph_entry *g = find_glyph(f, cps[i]);
+    acc += g ? g->advance : 0;
+  }
+  *table_gps = bench_gps(n, cpuEndTiming());
+  sink += acc;
+  (void)sink;
+
+  free(cps);
+  return n;
 }
+#endif
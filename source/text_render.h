@@ -8,6 +8,10 @@ enum {
   TR_SCREEN_H = 192,
 };
 
+enum {
+  TR_RING_H = 256, /* rows in a bitmap target; the screen is a window on it */
+};
+
 enum {
   TR_SCREEN_TOP = 0,
   TR_SCREEN_BOTTOM = 1,
@@ -32,6 +36,11 @@ typedef struct {
   uint16_t atlas_idx;
 } tr_glyph_entry;
 
+enum {
+  TR_GLYPH_PAGES = 256, /* BMP split into 256-codepoint pages */
+  TR_NO_GLYPH = 0xFFFF,
+};
+
 typedef struct {
   uint8_t glyph_w;
   uint8_t glyph_h;
@@ -40,9 +49,39 @@ typedef struct {
   uint8_t row_bytes;
 
   tr_glyph_entry *glyphs;
-  uint8_t *bitmaps;
+  /* glyph_h rows per atlas entry, expanded at load: bit n = column n */
+  uint16_t *masks;
+
+  /* direct lookup: page_of[cp >> 8] is a 1-based slot in pages (0 = no
+   * glyphs in that page), pages[slot - 1][cp & 0xFF] a glyph index */
+  uint8_t page_of[TR_GLYPH_PAGES];
+  uint16_t num_pages;
+  uint16_t (*pages)[256];
 } tr_font;
 
+/* one positioned glyph of a laid-out line; spaces are not stored */
+typedef struct {
+  const tr_glyph_entry *g; /* nil: codepoint missing from the font */
+  int16_t x;
+  uint16_t off; /* byte offset of the codepoint in the source text */
+  uint8_t row;
+  uint8_t len; /* UTF-8 length of the codepoint */
+} tr_run_glyph;
+
+/* a wrapped line, measured once and cached per (font, key, geometry) */
+typedef struct {
+  const tr_font *font;
+  uint32_t key;
+  int16_t x_start;
+  int16_t x_indent;
+  int16_t max_x;
+  int16_t rows;
+  int count;
+  int cap;
+  uint32_t stamp;
+  tr_run_glyph *glyphs;
+} tr_layout;
+
 tr_font *tr_load_font(const char *path);
 void tr_free_font(tr_font *f);
 
@@ -50,7 +89,12 @@ void tr_init_fb(void);
 void tr_init_fb_sub(void);
 void tr_select(int screen);
 void tr_flip(void);
+void tr_present(void);
+void tr_vblank(void);
 void tr_clear(uint16_t color);
+void tr_set_clip(int y0, int y1);
+int tr_can_scroll(void);
+void tr_scroll_bottom(int origin);
 void tr_fill_rect(int x, int y, int w, int h, uint16_t color);
 
 int tr_draw_text(const tr_font *f, int x, int y, const char *utf8,
@@ -63,8 +107,21 @@ int tr_word_at_pos(const tr_font *f, int x_start, int x_indent, int y,
                    int max_x, const char *utf8, int px, int py, char *out,
                    int out_len);
 
+const tr_layout *tr_layout_find(const tr_font *f, uint32_t key, int x_start,
+                                int x_indent, int max_x);
+const tr_layout *tr_layout_text(const tr_font *f, uint32_t key, int x_start,
+                                int x_indent, int max_x, const char *utf8);
+int tr_draw_layout(const tr_layout *lo, int y, uint16_t color);
+int tr_layout_word_at(const tr_layout *lo, const char *utf8, int y, int px,
+                      int py, char *out, int out_len, int *out_off);
+
 void tr_draw_pixel(int x, int y, uint16_t color);
 void tr_draw_line(int x0, int y0, int x1, int y1, uint16_t color);
 void tr_draw_hline(int x, int y, int w, uint16_t color);
 int tr_text_width(const tr_font *f, const char *utf8);
 void tr_draw_heartbeat(int frame);
+
+#ifdef LEXIS_BENCH
+int tr_bench_lookup(const tr_font *f, const char *utf8, uint32_t *bsearch_gps,
+                    uint32_t *table_gps);
+#endif
@@ -0,0 +1,209 @@
+#include "tile_canvas.h"
+#include "common.h"
+
+#include <nds.h>
+#include <string.h>
+
+void tc_palette_init(tc_palette *pal, volatile uint16_t *hw, int reserved) {
+  memset(pal, 0, sizeof(*pal));
+  pal->hw = hw;
+  /* slot 0 is transparent, the rest of the reserved ones are clear colors */
+  pal->reserved = reserved;
+  pal->used = reserved;
+}
+
+static int color_dist(uint16_t a, uint16_t b) {
+  int d = 0;
+  for (int shift = 0; shift < 15; shift += 5) {
+    int ca = (a >> shift) & 31, cb = (b >> shift) & 31;
+    d += ca > cb ? ca - cb : cb - ca;
+  }
+  return d;
+}
+
+/* a new color takes a fresh slot, else one no canvas uses any more; only
+ * with every slot taken does it fall back to the nearest one.  the
+ * clear-color slots are never matched: they change under the other
+ * canvases' feet */
+static uint8_t color_index(tc_canvas *c, uint16_t color) {
+  tc_palette *pal = c->pal;
+  color &= 0x7FFF;
+  if (pal->last_idx && pal->last_color == color) {
+    pal->users[pal->last_idx] |= c->bit;
+    return pal->last_idx;
+  }
+
+  int best = 0, best_d = 1 << 16, free_idx = 0;
+  for (int i = pal->reserved; i < pal->used && best_d; i++) {
+    int d = color_dist(pal->color[i], color);
+    if (d < best_d) {
+      best = i;
+      best_d = d;
+    }
+    if (!free_idx && !pal->users[i])
+      free_idx = i;
+  }
+  if (best_d && (pal->used < TC_COLORS || free_idx)) {
+    best = pal->used < TC_COLORS ? pal->used++ : free_idx;
+    pal->color[best] = color;
+    pal->hw[best] = color;
+  }
+  pal->users[best] |= c->bit;
+  pal->last_color = color;
+  pal->last_idx = (uint8_t)best;
+  return (uint8_t)best;
+}
+
+static void fill_tile(uint16_t *tile, uint8_t idx) {
+  uint32_t v = idx * 0x01010101u;
+  uint32_t *p = (uint32_t *)tile;
+  for (int i = 0; i < TC_TILE_BYTES / 4; i++)
+    p[i] = v;
+}
+
+void tc_init(tc_canvas *c, tc_palette *pal, int bg, int map_base,
+             int tile_base, uint16_t *map, uint16_t *tiles, uint8_t bg_idx) {
+  c->map = map;
+  c->tiles = tiles;
+  c->pal = pal;
+  c->bg = bg;
+  c->map_base = map_base;
+  c->tile_base = tile_base;
+  c->bg_idx = bg_idx;
+  c->bit = (uint8_t)(1u << pal->canvases++);
+  fill_tile(tiles, bg_idx);
+  memset(map, 0, TC_COLS * TC_COLS * sizeof(*map));
+  memset(c->live, 0, sizeof(c->live));
+}
+
+void tc_show(const tc_canvas *c) {
+  bgSetMapBase(c->bg, c->map_base);
+  bgSetTileBase(c->bg, c->tile_base);
+  bgUpdate();
+}
+
+/* the clear color lives in the canvas's own palette slot, so the blank
+ * tile never has to be rewritten */
+void tc_clear(tc_canvas *c, uint16_t color) {
+  if (!c)
+    return;
+  tc_palette *pal = c->pal;
+  pal->color[c->bg_idx] = color & 0x7FFF;
+  pal->hw[c->bg_idx] = color & 0x7FFF;
+  for (int i = pal->reserved; i < pal->used; i++)
+    pal->users[i] &= (uint8_t)~c->bit;
+#ifndef LEXIS_NO_DMA
+  dmaFillWords(0, c->map, TC_CELLS * sizeof(*c->map));
+#else
+  memset(c->map, 0, TC_CELLS * sizeof(*c->map));
+#endif
+  memset(c->live, 0, sizeof(c->live));
+}
+
+static uint16_t *cell_tile(tc_canvas *c, int cell) {
+  uint16_t *tile = c->tiles + (cell + 1) * (TC_TILE_BYTES / 2);
+  if (!c->live[cell]) {
+    fill_tile(tile, c->bg_idx);
+    c->map[cell] = (uint16_t)(cell + 1);
+    c->live[cell] = 1;
+  }
+  return tile;
+}
+
+/* vram takes no byte stores: single pixels are a halfword read-modify-write */
+static void put_byte(uint16_t *hw, int odd, uint8_t idx) {
+  *hw = odd ? (uint16_t)((*hw & 0x00FF) | (idx << 8))
+            : (uint16_t)((*hw & 0xFF00) | idx);
+}
+
+void tc_pixel(tc_canvas *c, int x, int y, uint16_t color) {
+  if (!c)
+    return;
+  uint8_t idx = color_index(c, color);
+  uint16_t *tile = cell_tile(c, (y >> 3) * TC_COLS + (x >> 3));
+  put_byte(&tile[((y & 7) * 8 + (x & 7)) >> 1], x & 1, idx);
+}
+
+/* x, y, w already clipped to the screen */
+void tc_span(tc_canvas *c, int x, int y, int w, uint16_t color) {
+  if (!c || w <= 0)
+    return;
+  uint8_t idx = color_index(c, color);
+  uint16_t pair = (uint16_t)(idx * 0x0101u);
+  int end = x + w;
+  int row = (y >> 3) * TC_COLS;
+  int sub = (y & 7) * 4;
+  while (x < end) {
+    uint16_t *line = cell_tile(c, row + (x >> 3)) + sub;
+    int stop = (x | 7) + 1;
+    if (stop > end)
+      stop = end;
+    if (x & 1) {
+      put_byte(&line[(x & 7) >> 1], 1, idx);
+      x++;
+    }
+    for (; x + 1 < stop; x += 2)
+      line[(x & 7) >> 1] = pair;
+    if (x < stop) {
+      put_byte(&line[(x & 7) >> 1], 0, idx);
+      x++;
+    }
+  }
+}
+
+/* same clipping and pixel pairing as the bitmap blitter; a pair is one
+ * halfword of a tile row */
+ITCM_CODE ARM_CODE void tc_blit_rows(tc_canvas *c, const uint16_t *rows, int h,
+                                     int w, int x, int y, uint16_t color) {
+  if (!c || x >= TC_COLS * 8 || x + w <= 0)
+    return;
+  int r0 = y < 0 ? -y : 0;
+  int r1 = h;
+  if (y + r1 > TC_ROWS * 8)
+    r1 = TC_ROWS * 8 - y;
+  if (r0 >= r1)
+    return;
+
+  int base = x & ~1;
+  int shift = x - base;
+  int skip = 0;
+  uint32_t clip = ~0u;
+  if (base < 0) {
+    skip = -base;
+    base = 0;
+  }
+  if (TC_COLS * 8 - base < 32)
+    clip = (1u << (TC_COLS * 8 - base)) - 1;
+
+  uint8_t idx = color_index(c, color);
+  uint16_t pair = (uint16_t)(idx * 0x0101u);
+
+  for (int r = r0; r < r1; r++) {
+    uint32_t m = (((uint32_t)rows[r] << shift) >> skip) & clip;
+    int py = y + r;
+    int row = (py >> 3) * TC_COLS;
+    int sub = (py & 7) * 4;
+    int cell = -1;
+    uint16_t *line = nil;
+    for (int col = base; m; m >>= 2, col += 2) {
+      if (!(m & 3))
+        continue;
+      if (row + (col >> 3) != cell) {
+        cell = row + (col >> 3);
+        line = cell_tile(c, cell) + sub;
+      }
+      uint16_t *hw = &line[(col & 7) >> 1];
+      switch (m & 3) {
+      case 1:
+        put_byte(hw, 0, idx);
+        break;
+      case 2:
+        put_byte(hw, 1, idx);
+        break;
+      case 3:
+        *hw = pair;
+        break;
+      }
+    }
+  }
+}
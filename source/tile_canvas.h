@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+
+/* 8bpp tiled stand-in for a 16bpp bitmap screen.  every map cell starts
+ * on a shared blank tile; a cell gets its own tile the first time
+ * something is drawn into it, so clearing a screen is a map reset and
+ * text only costs the tiles under its glyphs. */
+
+enum {
+  TC_COLS = 32,
+  TC_ROWS = 24,
+  TC_CELLS = TC_COLS * TC_ROWS,
+  TC_TILE_BYTES = 64,
+  TC_COLORS = 256,
+};
+
+/* one engine's BG palette, handed out to 16-bit colors on first use.  a
+ * slot goes back to the pool once every canvas drawn in it is cleared */
+typedef struct {
+  volatile uint16_t *hw;
+  uint16_t color[TC_COLORS];
+  uint8_t users[TC_COLORS]; /* canvas bits of those drawn in the slot */
+  int reserved;
+  int used;
+  int canvases; /* canvases handed a bit so far */
+  uint16_t last_color;
+  uint8_t last_idx;
+} tc_palette;
+
+typedef struct {
+  uint16_t *map;   /* 32x32 entries, rows past TC_ROWS stay blank */
+  uint16_t *tiles; /* tile 0 is the blank tile, cell i owns tile i + 1 */
+  tc_palette *pal;
+  int bg;
+  int map_base;
+  int tile_base;
+  uint8_t bg_idx; /* palette slot holding this canvas's clear color */
+  uint8_t bit;    /* this canvas in its palette's users */
+  uint8_t live[TC_CELLS];
+} tc_canvas;
+
+void tc_palette_init(tc_palette *pal, volatile uint16_t *hw, int reserved);
+void tc_init(tc_canvas *c, tc_palette *pal, int bg, int map_base,
+             int tile_base, uint16_t *map, uint16_t *tiles, uint8_t bg_idx);
+void tc_show(const tc_canvas *c);
+
+void tc_clear(tc_canvas *c, uint16_t color);
+void tc_pixel(tc_canvas *c, int x, int y, uint16_t color);
+void tc_span(tc_canvas *c, int x, int y, int w, uint16_t color);
+void tc_blit_rows(tc_canvas *c, const uint16_t *rows, int h, int w, int x,
+                  int y, uint16_t color);
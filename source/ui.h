@@ -6,7 +6,9 @@
 #include "drawing.h"
 #include "keyboard.h"
 #include "notes.h"
+#include "profile.h"
 #include "reader.h"
+#include "rows.h"
 #include "text_render.h"
 
 
@@ -15,6 +17,8 @@ enum {
   MAX_WORD_LEN = 64,
   NUM_ZOOM_LEVELS = 5,
   NUM_FONT_FAMILIES = 3,
+  FONT_CACHE_FONTS = 6, /* fonts kept loaded at once */
+  UI_ZOOM = 1,          /* the size bars and settings are drawn in */
   MAX_BOOKS = 24, /* TODO: derive from compiled DB */
 
   NUM_PRESET_PALETTES = 3,
@@ -23,9 +27,16 @@ enum {
 
   MAX_RESULT_LINES = 60,
   MAX_RESULT_LEN = 128,
+  MAX_SEARCH_HITS = 500, /* lines a search lists */
+  MAX_SEARCH_ROWS = 24,  /* of them on screen, at most */
+  MAX_OCCURRENCES = 3,   /* lines the lookup screen shows of a lemma */
+  MAX_BROWSE_ROWS = 24,  /* lemmas on screen while browsing, at most */
 
   BAR_TIMEOUT_FRAMES = 180, /* ~3 seconds at 60 fps */
   LINE_FETCH_EXTRA = 10,    /* extra lines to fetch beyond page */
+  SCROLL_STEP_PX = 2,       /* smooth scroll speed, pixels per frame */
+  SCROLLBAR_W = 2,          /* position bar on the top screen's right edge */
+  SCROLLBAR_MIN_H = 4,
 
   LOG_MAX_LINES = 32,
   LOG_LINE_LEN  = 64,
@@ -41,11 +52,13 @@ typedef struct {
 typedef enum {
   ST_READ,
   ST_LOOKUP,
+  ST_SEARCH,
   ST_BAR,
   ST_SETTINGS,
   ST_PICKER,
   ST_KB_GOTO,
   ST_KB_LATIN,
+  ST_KB_DICT,
   ST_DRAW,
 } app_state_t;
 
@@ -62,13 +75,22 @@ typedef struct {
   int indent;
 } result_line;
 
+/* a word tapped on the bottom screen and where it sits in the text */
+typedef struct {
+  char word[MAX_WORD_LEN];
+  int book;
+  int line;
+  int off; /* byte offset of the word in the line */
+} tap_word;
+
 extern const int g_zoom_sizes[NUM_ZOOM_LEVELS];
 extern const char *g_font_family_names[NUM_FONT_FAMILIES];
+/* nil until loaded, see font_get() */
 extern tr_font *g_all_fonts[NUM_FONT_FAMILIES][NUM_ZOOM_LEVELS];
-extern tr_font *g_fonts[NUM_ZOOM_LEVELS];
 extern tr_font *g_font;
 extern int g_zoom_level;
 extern int g_font_family;
+extern int g_font_next; /* family being loaded to switch to, -1 = none */
 
 extern reader_ctx *g_ctx;
 extern int g_num_books;
@@ -115,14 +137,37 @@ int load_state(void);
 
 int lines_per_screen(void);
 void recompute_page_lines(void);
+int line_text_x(int line);
 void show_text(void);
-
-
-int touch_to_word(int tx, int ty, char *out_word, int out_len);
+/* a page on (1) or back (-1), as R/L do */
+void turn_page(int dir);
+/* spends what is left of the frame warming the next pages; 1 while work
+ * is left */
+int idle_work(void);
+
+/* fonts are loaded on first use; past FONT_CACHE_FONTS the least recently
+ * used goes, never the font on show or its family's UI_ZOOM size.  a font
+ * that will not load answers with g_font */
+tr_font *font_get(int fam, int zoom);
+/* the current family at `zoom` */
+tr_font *ui_font(int zoom);
+/* the font if it is loaded; if not, nil, and an idle frame loads it */
+tr_font *font_ready(int fam, int zoom);
+/* switches to family `fam` once idle frames have loaded it; the old one
+ * stays on show meanwhile */
+void font_switch(int fam);
+/* loads one font asked for: FONTS_NONE with nothing to load, FONTS_REDRAW
+ * when the screen should be drawn again */
+enum { FONTS_NONE, FONTS_LOADED, FONTS_REDRAW };
+int fonts_idle(void);
+
+
+int touch_to_word(int tx, int ty, tap_word *out);
 
 
 void result_push(const char *text, uint16_t color, int indent);
 void build_lookup_result(const char *word, int dict_mode);
+void build_tap_result(const tap_word *tap);
 void draw_lookup_result(void);
 
 app_state_t on_lookup_TOUCH(app_state_t s);
@@ -130,10 +175,29 @@ app_state_t on_lookup_B(app_state_t s);
 app_state_t on_lookup_DOWN(app_state_t s);
 app_state_t on_lookup_UP(app_state_t s);
 app_state_t on_lookup_Y(app_state_t s);
+app_state_t on_lookup_X(app_state_t s);
+
+void draw_search_result(void);
+app_state_t on_search_A(app_state_t s);
+app_state_t on_search_B(app_state_t s);
+app_state_t on_search_X(app_state_t s);
+app_state_t on_search_UP(app_state_t s);
+app_state_t on_search_DOWN(app_state_t s);
+app_state_t on_search_LEFT(app_state_t s);
+app_state_t on_search_RIGHT(app_state_t s);
+
+void browse_run(void);
+void draw_browse_result(void);
+app_state_t browse_open(void);
+app_state_t on_browse_UP(app_state_t s);
+app_state_t on_browse_DOWN(app_state_t s);
+app_state_t on_browse_LEFT(app_state_t s);
+app_state_t on_browse_RIGHT(app_state_t s);
 
 
 void draw_settings(void);
 void draw_bar(void);
+void draw_prof_overlay(void);
 void draw_picker(void);
 void preview_top(void);
 